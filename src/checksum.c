@@ -0,0 +1,172 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+
+#include <string.h>
+#include "checksum.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WR_CKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+/** Blocks longer than this are summed in chunks, so 32-bit lanes of vector sums do not overflow */
+#define WR_CKSUM_CHUNK (1 << 16)
+
+
+
+static uint32_t __fold(uint64_t sum)
+{
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint32_t)sum;
+}
+
+
+
+/**
+ * Sum of the words of the tail which is shorter than a vector
+ */
+static uint64_t __sum_scalar(const uint8_t * data, size_t size)
+{
+    uint64_t sum = 0;
+    uint16_t word;
+    while (size >= 2){
+        memcpy(&word, data, 2);
+        sum += word;
+        data += 2;
+        size -= 2;
+    }
+    if (size){
+        word = 0;
+        memcpy(&word, data, 1);
+        sum += word;
+    }
+    return sum;
+}
+
+
+#ifdef WR_CKSUM_X86
+
+__attribute__((target("sse2")))
+static uint64_t __sum_sse2(const uint8_t * data, size_t size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    uint32_t lanes[4];
+    while (size >= 16){
+        __m128i v = _mm_loadu_si128((const __m128i *)data);
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+        data += 16;
+        size -= 16;
+    }
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + __sum_scalar(data, size);
+}
+
+
+
+__attribute__((target("avx2")))
+static uint64_t __sum_avx2(const uint8_t * data, size_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t lanes[8];
+    while (size >= 32){
+        __m256i v = _mm256_loadu_si256((const __m256i *)data);
+        acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+        acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+        data += 32;
+        size -= 32;
+    }
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           lanes[4] + lanes[5] + lanes[6] + lanes[7] + __sum_sse2(data, size);
+}
+
+#endif
+
+
+
+static uint64_t __sum(const uint8_t * data, size_t size)
+{
+#ifdef WR_CKSUM_X86
+    static int isa = -1;
+    int value = __atomic_load_n(&isa, __ATOMIC_RELAXED);
+    if (value < 0){
+        __builtin_cpu_init();
+        value = __builtin_cpu_supports("avx2") ? 2 : (__builtin_cpu_supports("sse2") ? 1 : 0);
+        __atomic_store_n(&isa, value, __ATOMIC_RELAXED);
+    }
+    if (value == 2)
+        return __sum_avx2(data, size);
+    if (value == 1)
+        return __sum_sse2(data, size);
+#endif
+    return __sum_scalar(data, size);
+}
+
+
+
+uint32_t wr_cksum_add(uint32_t sum, const void * data, size_t size)
+{
+    const uint8_t * ptr = data;
+    uint64_t total = sum;
+    while (size > WR_CKSUM_CHUNK){
+        total = __fold(total + __sum(ptr, WR_CKSUM_CHUNK));
+        ptr += WR_CKSUM_CHUNK;
+        size -= WR_CKSUM_CHUNK;
+    }
+    return __fold(total + __sum(ptr, size));
+}
+
+
+
+uint16_t wr_cksum_finish(uint32_t sum)
+{
+    return (uint16_t)~__fold(sum);
+}
+
+
+
+uint16_t wr_cksum_update(uint16_t cksum, uint16_t old_word, uint16_t new_word)
+{
+    /* HC' = ~(~HC + ~m + m') */
+    uint32_t sum = (uint16_t)~cksum + (uint16_t)~old_word + (uint32_t)new_word;
+    return (uint16_t)~__fold(sum);
+}
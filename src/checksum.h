@@ -0,0 +1,67 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+#include <stddef.h>
+#include <stdint.h>
+
+/** @defgroup checksum internet checksum
+ * Ones' complement checksum of IP and UDP headers.
+ * Words are summed as they are stored in memory, so the result may be stored into
+ * the header without byte swapping, and partial sums of several blocks may be added together.
+ * The sum is vectorized with SSE2 or AVX2 on x86 processors which support it.
+ *  @{
+ */
+
+/**
+ * Add 16-bit words of the block to the partial sum (odd byte at the end is padded with zero)
+ */
+uint32_t wr_cksum_add(uint32_t sum, const void * data, size_t size);
+
+/**
+ * Fold the partial sum to 16 bits and return its complement (value of the checksum field)
+ */
+uint16_t wr_cksum_finish(uint32_t sum);
+
+/**
+ * Update the checksum when one 16-bit word of the header was changed (RFC 1624, eqn. 3)
+ * @param cksum old value of the checksum field
+ * @param old_word old value of the changed word
+ * @param new_word new value of the changed word
+ */
+uint16_t wr_cksum_update(uint16_t cksum, uint16_t old_word, uint16_t new_word);
+
+/** @} */
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checksum.h"
+#include "pcap_filter.h"
+#define CHECK(f) { err=(f); if (err) {wr_print_error(); return 1;}  }
+/* offsets of IP and UDP headers in the ETH + IP + UDP frame */
+#define IP_OFFSET 14
+#define UDP_OFFSET (14 + 20)
+#define ASSERT(cond, ...) { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); return 1; } }
+
+char wr_error[2048];
+
+
+/**
+ * Checksum computed from scratch word by word (the reference for vectorized and incremental versions)
+ */
+static uint16_t reference_cksum(const uint8_t * data, size_t size)
+{
+    uint64_t sum = 0;
+    uint16_t word;
+    size_t i;
+    for (i = 0; i + 1 < size; i += 2){
+        memcpy(&word, data + i, 2);
+        sum += word;
+    }
+    if (size & 1){
+        word = 0;
+        memcpy(&word, data + size - 1, 1);
+        sum += word;
+    }
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+
+/**
+ * Checksum of the UDP datagram of the frame with the pseudo header, computed from scratch
+ */
+static uint16_t reference_udp_cksum(const uint8_t * frame)
+{
+    uint8_t datagram[WR_PCAP_LINK_HEADERS_SIZE + 65536];
+    uint16_t udp_len;
+    memcpy(&udp_len, frame + UDP_OFFSET + 4, 2);
+    udp_len = (uint16_t)((((uint8_t *)&udp_len)[0] << 8) | ((uint8_t *)&udp_len)[1]);
+    /* pseudo header: source and destination addresses, zero, protocol, UDP length */
+    memcpy(datagram, frame + IP_OFFSET + 12, 8);
+    datagram[8] = 0;
+    datagram[9] = 17;
+    datagram[10] = udp_len >> 8;
+    datagram[11] = udp_len & 0xff;
+    memcpy(datagram + 12, frame + UDP_OFFSET, udp_len);
+    return reference_cksum(datagram, 12 + udp_len);
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    static uint8_t buffer[(1 << 20) + 64];
+    size_t i;
+
+    char * av[] = {
+        "checksum_test", "--codec-list", "PCMU", "--to-file", "dontcare.pcap", "--from-file", "dontcare.wav"
+    };
+    CHECK( get_options(7, av, "../conf/wav2rtp/codecs.conf", "../conf/wav2rtp/output.conf") );
+
+    srand(1);
+    for (i = 0; i < sizeof(buffer); i++)
+        buffer[i] = rand();
+
+    /* Vectorized sum: all short lengths (odd ones too) at all alignments, lengths around the chunk boundary */
+    {
+        size_t sizes[] = {65534, 65535, 65536, 65537, 65538, 131072, 131073, 200001, 1 << 20};
+        size_t size, offset;
+        for (offset = 0; offset < 32; offset++){
+            for (size = 0; size < 300; size++)
+                ASSERT(wr_cksum_finish(wr_cksum_add(0, buffer + offset, size)) == reference_cksum(buffer + offset, size),
+                        "wrong checksum of %u bytes at offset %u", (unsigned)size, (unsigned)offset);
+            for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+                ASSERT(wr_cksum_finish(wr_cksum_add(0, buffer + offset, sizes[i])) == reference_cksum(buffer + offset, sizes[i]),
+                        "wrong checksum of %u bytes at offset %u", (unsigned)sizes[i], (unsigned)offset);
+        }
+        /* partial sums of blocks of even size may be added */
+        ASSERT(wr_cksum_finish(wr_cksum_add(wr_cksum_add(0, buffer, 70000), buffer + 70000, 70001)) == reference_cksum(buffer, 140001),
+                "partial sums do not match");
+        /* the largest words: 32-bit lanes must not overflow inside the chunk */
+        memset(buffer, 0xff, sizeof(buffer));
+        ASSERT(wr_cksum_finish(wr_cksum_add(0, buffer, 1 << 20)) == reference_cksum(buffer, 1 << 20), "wrong checksum of 0xffff words");
+        for (i = 0; i < sizeof(buffer); i++)
+            buffer[i] = rand();
+    }
+
+    /* Incremental update of one word (RFC 1624) */
+    {
+        uint8_t header[20];
+        uint16_t cksum, old_word, new_word;
+        int k;
+        for (k = 0; k < 100000; k++){
+            int word = rand() % 10;
+            for (i = 0; i < sizeof(header); i++)
+                header[i] = rand();
+            /* zero header is not checked: its checksum may be 0 or 0xffff (RFC 1624, section 3) */
+            if (k == 0)
+                memset(header, 0xff, sizeof(header));
+            memset(header + 10, 0, 2);
+            cksum = reference_cksum(header, sizeof(header));
+            memcpy(&old_word, header + 2 * word, 2);
+            new_word = (k % 7 == 0) ? 0 : (k % 11 == 0 ? 0xffff : rand());
+            if (word == 5)
+                new_word = old_word;
+            memcpy(header + 2 * word, &new_word, 2);
+            ASSERT(wr_cksum_update(cksum, old_word, new_word) == reference_cksum(header, sizeof(header)),
+                    "wrong incremental checksum, word %d %04x -> %04x", word, old_word, new_word);
+        }
+    }
+
+    /* Headers of pcap frames */
+    {
+        wr_pcap_link_template_t link_template;
+        static uint8_t frame[WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t) + 65536];
+        size_t payload_offset = WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t);
+        size_t max_payload = 65535 - 20 - 8 - sizeof(wr_rtp_header_t);
+        size_t payload_sizes[] = {0, 1, 2, 3, 33, 160, 161, 1399, 1400, 8191, max_payload - 1, max_payload};
+        wr_rtp_packet_t p;
+        uint16_t udp_sum;
+
+        iniparser_setstr(wr_options.output_options, "global:udp_checksum", "true");
+        CHECK( wr_pcap_link_template_init(&link_template) );
+        CHECK( wr_rtp_packet_init(&p, 0, 0, 0, 0, 0) );
+        for (i = 0; i < sizeof(payload_sizes) / sizeof(payload_sizes[0]); i++){
+            p.payload_size = payload_sizes[i];
+            p.sequence_number = i;
+            memcpy(frame + payload_offset, buffer + i, p.payload_size);
+            ASSERT(wr_pcap_link_template_fill(&link_template, frame, &p) == payload_offset + p.payload_size, "wrong frame length");
+            ASSERT(reference_cksum(frame + IP_OFFSET, 20) == 0, "wrong IP checksum, payload %u", (unsigned)p.payload_size);
+            ASSERT(reference_udp_cksum(frame) == 0, "wrong UDP checksum, payload %u", (unsigned)p.payload_size);
+        }
+
+        /* datagram whose sum is 0xffff: its checksum 0 is sent as 0xffff */
+        p.payload_size = 160;
+        memset(frame + payload_offset, 0, p.payload_size);
+        wr_pcap_link_template_fill(&link_template, frame, &p);
+        memcpy(&udp_sum, frame + UDP_OFFSET + 6, 2);
+        memcpy(frame + payload_offset, &udp_sum, 2);
+        wr_pcap_link_template_fill(&link_template, frame, &p);
+        memcpy(&udp_sum, frame + UDP_OFFSET + 6, 2);
+        ASSERT(udp_sum == 0xffff, "zero UDP checksum is not sent as 0xffff: %04x", udp_sum);
+        ASSERT(reference_udp_cksum(frame) == 0, "wrong UDP checksum of the datagram with zero sum");
+
+        wr_rtp_packet_destroy(&p);
+    }
+    return WR_OK;
+}
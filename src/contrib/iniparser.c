@@ -723,16 +723,17 @@ char * iniparser_getstr(dictionary * d, char * key)
 /*--------------------------------------------------------------------------*/
 char * iniparser_getstring(dictionary * d, char * key, char * def)
 {
-    char * lc_key ;
-    char * sval ;
+    /* key is converted on the stack, not with strlwc(): lookups may be done from several threads */
+    char lc_key[ASCIILINESZ+1];
+    int i ;
 
     if (d==NULL || key==NULL)
         return def ;
 
-    lc_key = strdup(strlwc(key));
-    sval = dictionary_get(d, lc_key, def);
-    free(lc_key);
-    return sval ;
+    for (i=0 ; key[i] && i<ASCIILINESZ ; i++)
+        lc_key[i] = (char)tolower((int)key[i]);
+    lc_key[i] = (char)0;
+    return dictionary_get(d, lc_key, def);
 }
 
 
@@ -0,0 +1,254 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "correlated_delay_filter.h"
+
+
+
+/**
+ * Parse list of states "mean:deviation:dwell, ..."
+ */
+static wr_errorcode_t __parse_modes(wr_correlated_delay_filter_state_t * state, const char * text)
+{
+    int capacity = 1;
+    const char * p;
+    for (p = text; *p; p++)
+        if (*p == ',')
+            capacity++;
+    state->modes = calloc(capacity, sizeof(wr_correlated_delay_mode_t));
+    if (!state->modes){
+        wr_set_error("cannot allocate memory for states of the correlated delay");
+        return WR_FATAL;
+    }
+    while (*text){
+        wr_correlated_delay_mode_t * mode = &state->modes[state->modes_count];
+        double * fields[3] = {&mode->mean, &mode->deviation, &mode->dwell};
+        int i;
+        for (i=0; i<3; i++){
+            char * end;
+            text += strspn(text, " \t");
+            *fields[i] = strtod(text, &end);
+            if (end == text){
+                wr_set_error("correlated_delay: each state has to be given as mean:deviation:dwell");
+                return WR_FATAL;
+            }
+            text = end + strspn(end, " \t");
+            if (i < 2){
+                if (*text != ':'){
+                    wr_set_error("correlated_delay: each state has to be given as mean:deviation:dwell");
+                    return WR_FATAL;
+                }
+                text++;
+            }
+        }
+        if (mode->mean < 0 || mode->deviation < 0 || mode->dwell < 1){
+            wr_set_error("correlated_delay: mean and deviation have to be non negative, dwell not less than 1");
+            return WR_FATAL;
+        }
+        state->modes_count++;
+        if (*text == ','){
+            text++;
+        } else if (*text){
+            wr_set_error("correlated_delay: states have to be separated by commas");
+            return WR_FATAL;
+        }
+    }
+    return WR_OK;
+}
+
+
+
+static wr_errorcode_t __read_options(wr_correlated_delay_filter_state_t * state)
+{
+    char * states = iniparser_getstring(wr_options.output_options, "correlated_delay:states", NULL);
+    state->fifo = iniparser_getboolean(wr_options.output_options, "correlated_delay:fifo", 0);
+    state->correlation = iniparser_getdouble(wr_options.output_options, "correlated_delay:correlation", 0);
+    if (state->correlation < 0)  state->correlation = 0;
+    if (state->correlation > 1)  state->correlation = 1;
+    if (states && *states){
+        if (__parse_modes(state, states) != WR_OK)
+            return WR_FATAL;
+        if (state->modes_count)
+            return WR_OK;
+    }
+    state->modes = calloc(1, sizeof(wr_correlated_delay_mode_t));
+    if (!state->modes){
+        wr_set_error("cannot allocate memory for states of the correlated delay");
+        return WR_FATAL;
+    }
+    state->modes_count = 1;
+    state->modes[0].mean = iniparser_getdouble(wr_options.output_options, "correlated_delay:mean", 0);
+    state->modes[0].deviation = iniparser_getdouble(wr_options.output_options, "correlated_delay:deviation", 0);
+    if (state->modes[0].mean < 0 || state->modes[0].deviation < 0){
+        wr_set_error("correlated_delay: mean and deviation have to be non negative");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Enter the state, the number of packets in it is geometric with the mean dwell
+ */
+static void __enter_mode(wr_correlated_delay_filter_state_t * state, int mode)
+{
+    state->mode = mode;
+    if (state->modes_count == 1){
+        state->dwell = UINT64_MAX;
+        return;
+    }
+    state->dwell = wr_prng_geometric(&state->mode_prng, 1 / state->modes[mode].dwell);
+    if (state->dwell != UINT64_MAX)
+        state->dwell++;
+}
+
+
+
+/**
+ * Compute delays of the packets, noise are samples of the standard normal distribution
+ */
+static void __apply(wr_correlated_delay_filter_state_t * state, wr_rtp_packet_t * packets, const double * noise, int count)
+{
+    double innovation = sqrt(1 - state->correlation * state->correlation);
+    int i;
+    for (i=0; i<count; i++){
+        wr_correlated_delay_mode_t * mode;
+        double delay;
+        wr_time_t departure;
+        if (!state->dwell){
+            /* next state is one of the others */
+            int next = wr_prng_uniform_int(&state->mode_prng, 0, state->modes_count - 2);
+            __enter_mode(state, (next >= state->mode) ? next + 1 : next);
+        }
+        state->dwell--;
+        mode = &state->modes[state->mode];
+        if (!state->started){
+            /* the first delay is drawn from the stationary distribution */
+            state->offset = mode->deviation * noise[i];
+            state->started = 1;
+        } else {
+            state->offset = state->correlation * state->offset + mode->deviation * innovation * noise[i];
+        }
+        delay = mode->mean + state->offset;
+        if (delay < 0)
+            delay = 0;
+        departure = packets[i].lowlevel_timestamp + (wr_time_t)(delay * WR_NSEC_PER_USEC);
+        if (state->fifo){
+            /* packet can not overtake the previous one */
+            if (departure < state->last_departure)
+                departure = state->last_departure;
+            state->last_departure = departure;
+        }
+        packets[i].lowlevel_timestamp = departure;
+    }
+}
+
+
+
+wr_errorcode_t wr_correlated_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_correlated_delay_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the correlated_delay filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "correlated_delay:enabled", 1);
+            if (state->enabled && (retval = __read_options(state)) != WR_OK){
+                /* packets pass unchanged */
+                state->enabled = 0;
+            }
+            /* noise and switches of the states use their own streams, so the delays do not depend on the batch size */
+            wr_prng_stream_init(&state->prng);
+            wr_prng_stream_init(&state->mode_prng);
+            if (state->enabled)
+                __enter_mode(state, wr_prng_uniform_int(&state->mode_prng, 0, state->modes_count - 1));
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_correlated_delay_filter_state_t * state = (wr_correlated_delay_filter_state_t * ) (filter->state);
+            wr_rtp_packet_t new_packet;
+            double noise;
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            noise = wr_prng_normal(&state->prng);
+            wr_rtp_packet_copy(&new_packet, packet);
+            __apply(state, &new_packet, &noise, 1);
+            wr_rtp_filter_notify_observers(filter, event, &new_packet);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_correlated_delay_filter_state_t * state = (wr_correlated_delay_filter_state_t * ) (filter->state);
+            free(state->modes);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_correlated_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_correlated_delay_filter_state_t * state = (wr_correlated_delay_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    double noise[count];
+    int i;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    wr_prng_fill_normal(&state->prng, noise, count);
+    for (i=0; i<count; i++){
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        new_packets_ptrs[i] = &new_packets[i];
+    }
+    __apply(state, new_packets, noise, count);
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, count);
+    return WR_OK;
+}
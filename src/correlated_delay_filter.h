@@ -0,0 +1,103 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef CORRELATED_DELAY_FILTER_H
+#define CORRELATED_DELAY_FILTER_H
+#include "rtpapi.h"
+#include "prng.h"
+#include "misc.h"
+
+/** @defgroup correlated_delay correlated delay filter
+ * This filter emulates delays of a queue: delay of the packet depends on the delay of the previous one.
+ * The delay follows AR(1) process around the mean of the current state:
+ *
+ *    delay[n] = mean + correlation * (delay[n-1] - mean) + deviation * sqrt(1 - correlation^2) * N(0, 1)
+ *
+ * so the deviation of the delay from the mean is "deviation" and its correlation between
+ * neighbouring packets is "correlation". With several states the mean and the deviation are
+ * modulated by the Markov chain: the number of packets in a state is geometric with the given
+ * mean, then the next state is chosen at random among the others.
+ * It uses section [correlated_delay] of the configuration file "output.ini"
+ * There is five used options (delays are in microseconds):
+ *
+ *    mean = float
+ *    deviation = float
+ *    correlation = float from 0 to 1
+ *    states = "mean:deviation:dwell, mean:deviation:dwell, ..." (instead of mean and deviation)
+ *    fifo = boolean
+ *
+ * If fifo is true, each delay is clamped to be at least the previous delay minus the
+ * inter-packet gap, so packets leave the filter in the order they came and the sort filter
+ * is not needed.
+ *  @{
+ */
+
+/** Parameters of one state of the delay */
+typedef struct __wr_correlated_delay_mode {
+    double mean;                        /**< mean delay (us) */
+    double deviation;                   /**< standard deviation of the delay (us) */
+    double dwell;                       /**< mean number of packets in the state */
+} wr_correlated_delay_mode_t;
+
+/** 
+ * Structure to store internal state of the delay filter
+ */
+typedef struct __wr_correlated_delay_filter_state {
+    int enabled;
+    int fifo;
+    double correlation;
+    wr_correlated_delay_mode_t * modes;
+    int modes_count;
+    int mode;                           /**< current state of the Markov chain */
+    uint64_t dwell;                     /**< number of packets left in the current state */
+    double offset;                      /**< deviation of the delay from the mean of the state (us) */
+    wr_time_t last_departure;           /**< timestamp of the last packet sent (fifo) */
+    int started;
+    wr_prng_t prng;                     /**< noise of the delays */
+    wr_prng_t mode_prng;                /**< switches of the states, so the noise of the whole batch is drawn at once */
+} wr_correlated_delay_filter_state_t;
+
+/**
+ * Delay packets of the input stream and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_correlated_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_correlated_delay_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_correlated_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "correlated_delay_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 20000
+#define INTERVAL (20 * WR_NSEC_PER_MSEC)
+
+
+/**
+ * Send the packets through the filter in batches of batch_size packets.
+ * Streams and the first state of the filter drawn on TRANSMISSION_START are saved to start
+ * when restore is 0 and taken from it otherwise, so transmissions with different batch sizes draw the same numbers.
+ */
+static void transmit(wr_rtp_filter_t * filter, wr_rtp_packet_t * packets, int batch_size,
+        wr_correlated_delay_filter_state_t * start, int restore)
+{
+    wr_correlated_delay_filter_state_t * state;
+    int i = 0;
+    filter->notify(filter, TRANSMISSION_START, &packets[0]);
+    state = (wr_correlated_delay_filter_state_t *)filter->state;
+    if (restore){
+        state->prng = start->prng;
+        state->mode_prng = start->mode_prng;
+        state->mode = start->mode;
+        state->dwell = start->dwell;
+    } else {
+        *start = *state;
+    }
+    while (i < PACKETS){
+        if (batch_size > 1){
+            wr_rtp_packet_t * batch[WR_MAX_BATCH_SIZE];
+            int n = 0;
+            while (i < PACKETS && n < batch_size)
+                batch[n++] = &packets[i++];
+            filter->notify_batch(filter, batch, n);
+        } else {
+            filter->notify(filter, NEW_PACKET, &packets[i++]);
+        }
+    }
+    filter->notify(filter, TRANSMISSION_END, NULL);
+}
+
+
+/**
+ * Count packets which are sent before the previous packet
+ */
+static int count_inversions(wr_rtp_filter_t * sink)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    int inversions = 0;
+    size_t i;
+    for (i = 1; i < state->count; i++)
+        if (state->records[i].lowlevel_timestamp < state->records[i - 1].lowlevel_timestamp)
+            inversions++;
+    return inversions;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t filter, sink;
+    wr_correlated_delay_filter_state_t start;
+    static wr_rtp_packet_t packets[PACKETS];
+    static wr_time_t expected[PACKETS];
+    int batch_sizes[] = {1, 8, WR_MAX_BATCH_SIZE};
+    char * fifo_options[] = {"correlated_delay:fifo=false", "correlated_delay:fifo=true"};
+    size_t i, b, f;
+
+    CHECK( wr_test_options_init("correlated_delay_test") );
+    CHECK( wr_test_set_option("correlated_delay:enabled=true") );
+    wr_prng_seed(7);
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&filter, "correlated_delay", &wr_correlated_delay_filter_notify, &wr_correlated_delay_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++)
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, i * INTERVAL) );
+
+    /* one state: mean and deviation of the delay */
+    CHECK( wr_test_set_option("correlated_delay:mean=30000") );
+    CHECK( wr_test_set_option("correlated_delay:deviation=5000") );
+    CHECK( wr_test_set_option("correlated_delay:correlation=0.5") );
+    CHECK( wr_test_transmit(&filter, packets, PACKETS, 1) );
+    {
+        wr_test_sink_state_t * state = wr_test_sink_state(&sink);
+        double sum = 0, sum2 = 0, mean, deviation;
+        ASSERT(state->count == PACKETS, "%u packets are received", (unsigned)state->count);
+        for (i = 0; i < PACKETS; i++){
+            double delay = (double)(state->records[i].lowlevel_timestamp - (wr_time_t)i * INTERVAL) / WR_NSEC_PER_USEC;
+            sum += delay;
+            sum2 += delay * delay;
+        }
+        mean = sum / PACKETS;
+        deviation = sqrt(sum2 / PACKETS - mean * mean);
+        ASSERT(fabs(mean - 30000) < 300, "mean delay is %.0f us instead of 30000 us", mean);
+        ASSERT(fabs(deviation - 5000) < 0.05 * 5000, "deviation of the delay is %.0f us instead of 5000 us", deviation);
+    }
+
+    /* three states with large deviations: delays of the packets differ by more than the gap between them */
+    CHECK( wr_test_set_option("correlated_delay:states=20000:5000:10, 50000:20000:5, 5000:1000:20") );
+    CHECK( wr_test_set_option("correlated_delay:correlation=0.3") );
+    for (f = 0; f < sizeof(fifo_options) / sizeof(fifo_options[0]); f++){
+        CHECK( wr_test_set_option(fifo_options[f]) );
+        for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+            wr_test_sink_state_t * state = wr_test_sink_state(&sink);
+            transmit(&filter, packets, batch_sizes[b], &start, b > 0);
+            ASSERT(state->finished && state->count == PACKETS, "%u packets are received", (unsigned)state->count);
+            /* with fifo packets leave in the order they came, without it some of them are swapped */
+            ASSERT(f ? count_inversions(&sink) == 0 : count_inversions(&sink) > 0, "%s: %d packets overtake the previous ones",
+                    fifo_options[f], count_inversions(&sink));
+            /* delays do not depend on the batch size */
+            for (i = 0; i < PACKETS; i++){
+                ASSERT(state->records[i].sequence_number == (int)i, "packet %u is received at position %u",
+                        (unsigned)state->records[i].sequence_number, (unsigned)i);
+                if (b == 0)
+                    expected[i] = state->records[i].lowlevel_timestamp;
+                ASSERT(state->records[i].lowlevel_timestamp == expected[i], "%s, batch of %d: packet %u is sent at %lld ns instead of %lld ns",
+                        fifo_options[f], batch_sizes[b], (unsigned)i, (long long)state->records[i].lowlevel_timestamp, (long long)expected[i]);
+            }
+        }
+    }
+
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -0,0 +1,326 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "misc.h"
+#include "distribution_delay_filter.h"
+
+
+
+/** Empirical distribution being read */
+typedef struct __wr_histogram {
+    double * values;
+    double * weights;
+    int count;
+    int capacity;
+} wr_histogram_t;
+
+
+
+static wr_errorcode_t __histogram_add(wr_histogram_t * histogram, double value, double weight)
+{
+    if (histogram->count == histogram->capacity){
+        int capacity = histogram->capacity ? 2 * histogram->capacity : 64;
+        double * values = realloc(histogram->values, capacity * sizeof(double));
+        double * weights;
+        if (values)
+            histogram->values = values;
+        weights = realloc(histogram->weights, capacity * sizeof(double));
+        if (weights)
+            histogram->weights = weights;
+        if (!values || !weights){
+            wr_set_error("cannot allocate memory for the delay distribution");
+            return WR_FATAL;
+        }
+        histogram->capacity = capacity;
+    }
+    histogram->values[histogram->count] = value;
+    histogram->weights[histogram->count] = weight;
+    histogram->count++;
+    return WR_OK;
+}
+
+
+
+/**
+ * Read pairs of numbers from the text, any non-numeric characters separate the numbers
+ */
+static wr_errorcode_t __histogram_parse(wr_histogram_t * histogram, const char * text)
+{
+    double numbers[2];
+    int n = 0;
+    while (*text){
+        char * end;
+        double number = strtod(text, &end);
+        if (end == text){
+            text++;
+            continue;
+        }
+        text = end;
+        numbers[n++] = number;
+        if (n == 2){
+            if (__histogram_add(histogram, numbers[0], numbers[1]) != WR_OK)
+                return WR_FATAL;
+            n = 0;
+        }
+    }
+    if (n){
+        wr_set_error("distribution_delay: weight of the last value is missing");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Read the file line by line, lines without two numbers (comments, header) are skipped
+ */
+static wr_errorcode_t __histogram_read(wr_histogram_t * histogram, const char * filename)
+{
+    char line[1024];
+    FILE * file = fopen(filename, "r");
+    if (!file){
+        wr_set_error("cannot open file of the delay distribution");
+        return WR_FATAL;
+    }
+    while (fgets(line, sizeof(line), file)){
+        double value, weight;
+        char * end;
+        char * p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '#')
+            continue;
+        value = strtod(p, &end);
+        if (end == p)
+            continue;
+        p = end + strspn(end, " \t,;:");
+        weight = strtod(p, &end);
+        if (end == p)
+            continue;
+        if (__histogram_add(histogram, value, weight) != WR_OK){
+            fclose(file);
+            return WR_FATAL;
+        }
+    }
+    fclose(file);
+    return WR_OK;
+}
+
+
+
+/**
+ * Read empirical distribution and build its alias table
+ */
+static wr_errorcode_t __empirical_init(wr_distribution_delay_filter_state_t * state)
+{
+    wr_histogram_t histogram;
+    wr_errorcode_t retval = WR_OK;
+    char * text = iniparser_getstring(wr_options.output_options, "distribution_delay:histogram", NULL);
+    char * filename = iniparser_getstring(wr_options.output_options, "distribution_delay:filename", NULL);
+
+    memset(&histogram, 0, sizeof(histogram));
+    if (filename && *filename)
+        retval = __histogram_read(&histogram, filename);
+    else if (text && *text)
+        retval = __histogram_parse(&histogram, text);
+    if (retval == WR_OK && histogram.count == 0){
+        /* no distribution, packets pass unchanged */
+        state->enabled = 0;
+    } else if (retval == WR_OK){
+        if (iniparser_getboolean(wr_options.output_options, "distribution_delay:cdf", 0)){
+            int i;
+            for (i=histogram.count - 1; i>0; i--)
+                histogram.weights[i] -= histogram.weights[i - 1];
+        }
+        retval = wr_prng_alias_init(&state->alias, histogram.weights, histogram.count);
+    }
+    free(histogram.weights);
+    if (retval == WR_OK && state->enabled){
+        state->values = histogram.values;
+        state->values_count = histogram.count;
+    } else {
+        free(histogram.values);
+    }
+    return retval;
+}
+
+
+
+static wr_errorcode_t __read_options(wr_distribution_delay_filter_state_t * state)
+{
+    char * distribution = iniparser_getstring(wr_options.output_options, "distribution_delay:distribution", "empirical");
+    state->shift = iniparser_getdouble(wr_options.output_options, "distribution_delay:shift", 0);
+    state->max_delay = iniparser_getdouble(wr_options.output_options, "distribution_delay:max_delay", 0);
+    if (!(state->max_delay > 0 && state->max_delay < WR_DISTRIBUTION_DELAY_MAX))
+        state->max_delay = WR_DISTRIBUTION_DELAY_MAX;
+    state->mu = iniparser_getdouble(wr_options.output_options, "distribution_delay:mu", 0);
+    state->sigma = iniparser_getdouble(wr_options.output_options, "distribution_delay:sigma", 0);
+    state->shape = iniparser_getdouble(wr_options.output_options, "distribution_delay:shape", 1);
+    state->scale = iniparser_getdouble(wr_options.output_options, "distribution_delay:scale", 0);
+    if (strcmp(distribution, "empirical") == 0){
+        state->distribution = WR_DELAY_EMPIRICAL;
+        return __empirical_init(state);
+    } else if (strcmp(distribution, "lognormal") == 0){
+        state->distribution = WR_DELAY_LOGNORMAL;
+    } else if (strcmp(distribution, "pareto") == 0){
+        state->distribution = WR_DELAY_PARETO;
+    } else if (strcmp(distribution, "gamma") == 0){
+        state->distribution = WR_DELAY_GAMMA;
+    } else {
+        wr_set_error("distribution_delay: unknown distribution");
+        return WR_FATAL;
+    }
+    if (state->sigma < 0 || state->shape <= 0 || state->scale < 0){
+        wr_set_error("distribution_delay: sigma, shape and scale have to be positive");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Draw delays (in microseconds) of the count packets
+ */
+static void __fill_delays(wr_distribution_delay_filter_state_t * state, double * delays, int count)
+{
+    int i;
+    switch (state->distribution){
+        case WR_DELAY_EMPIRICAL: {
+            int indices[count];
+            wr_prng_fill_alias(&state->prng, &state->alias, indices, count);
+            for (i=0; i<count; i++)
+                delays[i] = state->values[indices[i]];
+            break;
+        }
+        case WR_DELAY_LOGNORMAL:
+            wr_prng_fill_normal(&state->prng, delays, count);
+            for (i=0; i<count; i++)
+                delays[i] = exp(state->mu + state->sigma * delays[i]);
+            break;
+        case WR_DELAY_PARETO:
+            wr_prng_fill_uniform(&state->prng, delays, count);
+            for (i=0; i<count; i++)
+                delays[i] = state->scale * pow(1 - delays[i], -1 / state->shape);
+            break;
+        case WR_DELAY_GAMMA:
+            wr_prng_fill_gamma(&state->prng, state->shape, state->scale, delays, count);
+            break;
+    }
+    for (i=0; i<count; i++){
+        delays[i] += state->shift;
+        /* infinite lognormal and pareto values are clamped too */
+        if (!(delays[i] <= state->max_delay))
+            delays[i] = state->max_delay;
+        if (delays[i] < 0)
+            delays[i] = 0;
+    }
+}
+
+
+
+wr_errorcode_t wr_distribution_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_distribution_delay_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the distribution_delay filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "distribution_delay:enabled", 1);
+            if (state->enabled && (retval = __read_options(state)) != WR_OK){
+                /* packets pass unchanged */
+                state->enabled = 0;
+            }
+            wr_prng_stream_init(&state->prng);
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_distribution_delay_filter_state_t * state = (wr_distribution_delay_filter_state_t * ) (filter->state);
+            wr_rtp_packet_t new_packet;
+            double delay;
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            __fill_delays(state, &delay, 1);
+            wr_rtp_packet_copy(&new_packet, packet);
+            new_packet.lowlevel_timestamp += (wr_time_t)(delay * WR_NSEC_PER_USEC);
+            wr_rtp_filter_notify_observers(filter, event, &new_packet);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_distribution_delay_filter_state_t * state = (wr_distribution_delay_filter_state_t * ) (filter->state);
+            wr_prng_alias_destroy(&state->alias);
+            free(state->values);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_distribution_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_distribution_delay_filter_state_t * state = (wr_distribution_delay_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    double delays[count];
+    int i;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    __fill_delays(state, delays, count);
+    for (i=0; i<count; i++){
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        new_packets[i].lowlevel_timestamp += (wr_time_t)(delays[i] * WR_NSEC_PER_USEC);
+        new_packets_ptrs[i] = &new_packets[i];
+    }
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, count);
+    return WR_OK;
+}
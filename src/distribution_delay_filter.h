@@ -0,0 +1,107 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef DISTRIBUTION_DELAY_FILTER_H
+#define DISTRIBUTION_DELAY_FILTER_H
+#include "rtpapi.h"
+#include "prng.h"
+
+/** @defgroup distribution_delay distribution delay filter
+ * This filter emulates independent delays of the packets drawn from the empirical distribution
+ * (histogram or CDF) or from one of the heavy-tailed models with real-valued parameters.
+ * It uses section [distribution_delay] of the configuration file "output.ini"
+ * The distribution is selected by the option
+ *
+ *    distribution = empirical | lognormal | pareto | gamma
+ *
+ * Options of the distributions (delays are in microseconds):
+ *
+ *    empirical:  histogram = "value:weight, value:weight, ..." or filename = file with lines "value weight",
+ *                cdf = true if weights are cumulative probabilities (values in ascending order)
+ *    lognormal:  mu, sigma - mean and standard deviation of the logarithm of the delay
+ *    pareto:     scale (minimal value), shape (tail index)
+ *    gamma:      shape, scale
+ *
+ * Two options are common for all distributions:
+ *
+ *    shift = float, added to each delay (minimal delay of the path)
+ *    max_delay = float, delays are clamped to it (0 means WR_DISTRIBUTION_DELAY_MAX)
+ *
+ * Values of the empirical distribution are drawn with the alias method, in constant time
+ * with two random numbers per packet. If the empirical distribution has no values, packets pass unchanged.
+ *  @{
+ */
+
+/** Longest delay (one day in microseconds), heavy tails are clamped to it so timestamps do not overflow */
+#define WR_DISTRIBUTION_DELAY_MAX (86400.0 * 1000000.0)
+
+/** Models of the delay */
+typedef enum __wr_delay_distribution {
+    WR_DELAY_EMPIRICAL,
+    WR_DELAY_LOGNORMAL,
+    WR_DELAY_PARETO,
+    WR_DELAY_GAMMA,
+} wr_delay_distribution_t;
+
+/** 
+ * Structure to store internal state of the delay filter
+ */
+typedef struct __wr_distribution_delay_filter_state {
+    int enabled;
+    wr_delay_distribution_t distribution;
+    double shift;                       /**< added to each delay (us) */
+    double max_delay;                   /**< delays are clamped to it (us) */
+    double mu;                          /**< lognormal: mean of the logarithm */
+    double sigma;                       /**< lognormal: deviation of the logarithm */
+    double shape;                       /**< pareto, gamma: shape */
+    double scale;                       /**< pareto, gamma: scale */
+    double * values;                    /**< empirical: values of the distribution (us) */
+    int values_count;
+    wr_prng_alias_t alias;              /**< empirical: alias table of the weights */
+    wr_prng_t prng;
+} wr_distribution_delay_filter_state_t;
+
+/**
+ * Delay packets of the input stream and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_distribution_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_distribution_delay_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_distribution_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
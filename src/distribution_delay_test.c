@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <math.h>
+#include "distribution_delay_filter.h"
+#include "test_sink.h"
+
+#define DRAWS 1000000
+#define PACKETS 100000
+
+
+/**
+ * Draw indices from the alias table of the weights and compare their frequencies with the normalized weights
+ */
+static int check_alias(const double * weights, int count)
+{
+    wr_prng_alias_t table;
+    wr_prng_t prng;
+    static int values[DRAWS];
+    double sum = 0;
+    int hits[count];
+    int i;
+
+    wr_prng_stream_init(&prng);
+    ASSERT(wr_prng_alias_init(&table, weights, count) == WR_OK, "alias table is not built");
+    for (i = 0; i < count; i++){
+        hits[i] = 0;
+        sum += weights[i];
+    }
+    wr_prng_fill_alias(&prng, &table, values, DRAWS / 2);
+    for (i = DRAWS / 2; i < DRAWS; i++)
+        values[i] = wr_prng_alias_sample(&prng, &table);
+    for (i = 0; i < DRAWS; i++){
+        ASSERT(values[i] >= 0 && values[i] < count, "index %d is out of the table", values[i]);
+        hits[values[i]]++;
+    }
+    for (i = 0; i < count; i++){
+        double expected = weights[i] / sum;
+        double measured = (double)hits[i] / DRAWS;
+        /* five standard deviations of the frequency */
+        ASSERT(fabs(measured - expected) <= 5 * sqrt(expected * (1 - expected) / DRAWS),
+                "index %d of %d is drawn with frequency %f instead of %f", i, count, measured, expected);
+    }
+    wr_prng_alias_destroy(&table);
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t filter, sink;
+    wr_test_sink_state_t * state;
+    size_t i;
+
+    CHECK( wr_test_options_init("distribution_delay_test") );
+    wr_prng_seed(1);
+
+    /* Vose alias table */
+    {
+        double single[] = {5};
+        double small[] = {1, 2, 3, 4, 0, 10};
+        double uniform[] = {1, 1, 1, 1, 1, 1, 1};
+        double skewed[100];
+        double negative[] = {1, -1};
+        double zero[] = {0, 0};
+        wr_prng_alias_t table;
+        for (i = 0; i < 100; i++)
+            skewed[i] = (i == 50) ? 1000000 : (double)i * i * i;
+        if (check_alias(single, 1) || check_alias(small, 6) || check_alias(uniform, 7) || check_alias(skewed, 100))
+            return 1;
+        ASSERT(wr_prng_alias_init(&table, negative, 2) != WR_OK, "negative weight is accepted");
+        ASSERT(wr_prng_alias_init(&table, zero, 2) != WR_OK, "zero weights are accepted");
+    }
+
+    CHECK( wr_test_set_option("distribution_delay:enabled=true") );
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&filter, "distribution_delay", &wr_distribution_delay_filter_notify, &wr_distribution_delay_filter_notify_batch, &sink);
+    state = wr_test_sink_state(&sink);
+
+    /* empirical histogram through the filter */
+    {
+        size_t short_delays = 0;
+        CHECK( wr_test_set_option("distribution_delay:distribution=empirical") );
+        CHECK( wr_test_set_option("distribution_delay:histogram=100:1, 200:3") );
+        CHECK( wr_test_transmit_sequence(&filter, PACKETS, WR_MAX_BATCH_SIZE) );
+        ASSERT(state->count == PACKETS, "%u packets of %u are received", (unsigned)state->count, PACKETS);
+        for (i = 0; i < state->count; i++){
+            wr_time_t delay = state->records[i].lowlevel_timestamp;
+            ASSERT(delay == 100 * WR_NSEC_PER_USEC || delay == 200 * WR_NSEC_PER_USEC, "packet is delayed by %lld ns", (long long)delay);
+            short_delays += (delay == 100 * WR_NSEC_PER_USEC);
+        }
+        ASSERT(fabs((double)short_delays / PACKETS - 0.25) < 0.01, "share of the 100 us delay is %f instead of 0.25", (double)short_delays / PACKETS);
+    }
+
+    /* heavy tails without max_delay are clamped to WR_DISTRIBUTION_DELAY_MAX, timestamps do not overflow */
+    {
+        const char * models[][3] = {
+            {"distribution_delay:distribution=pareto", "distribution_delay:shape=0.01", "distribution_delay:scale=1000"},
+            {"distribution_delay:distribution=lognormal", "distribution_delay:mu=10", "distribution_delay:sigma=100"},
+        };
+        size_t m, k, clamped = 0;
+        CHECK( wr_test_set_option("distribution_delay:max_delay=0") );
+        for (m = 0; m < sizeof(models) / sizeof(models[0]); m++){
+            for (k = 0; k < 3; k++)
+                CHECK( wr_test_set_option(models[m][k]) );
+            CHECK( wr_test_transmit_sequence(&filter, PACKETS, (m & 1) ? 1 : WR_MAX_BATCH_SIZE) );
+            ASSERT(state->count == PACKETS, "%u packets of %u are received", (unsigned)state->count, PACKETS);
+            for (i = 0; i < state->count; i++){
+                wr_time_t delay = state->records[i].lowlevel_timestamp;
+                ASSERT(delay >= 0 && delay <= (wr_time_t)WR_DISTRIBUTION_DELAY_MAX * WR_NSEC_PER_USEC,
+                        "packet is delayed by %lld ns", (long long)delay);
+                clamped += (delay == (wr_time_t)WR_DISTRIBUTION_DELAY_MAX * WR_NSEC_PER_USEC);
+            }
+        }
+        ASSERT(clamped > 0, "no delay reaches the limit");
+
+        /* max_delay is used when it is given */
+        CHECK( wr_test_set_option("distribution_delay:max_delay=5000") );
+        CHECK( wr_test_transmit_sequence(&filter, PACKETS, WR_MAX_BATCH_SIZE) );
+        for (i = 0; i < state->count; i++)
+            ASSERT(state->records[i].lowlevel_timestamp <= 5000 * WR_NSEC_PER_USEC,
+                    "packet is delayed by %lld ns", (long long)state->records[i].lowlevel_timestamp);
+    }
+
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -0,0 +1,262 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "misc.h"
+#include "duplicate_reorder_filter.h"
+
+
+
+static wr_errorcode_t __read_options(wr_duplicate_reorder_filter_state_t * state)
+{
+    char * log_filename = iniparser_getstring(wr_options.output_options, "duplicate_reorder:log_filename", NULL);
+    state->duplicate_probability = iniparser_getdouble(wr_options.output_options, "duplicate_reorder:duplicate_probability", 0);
+    state->duplicate_burst = iniparser_getdouble(wr_options.output_options, "duplicate_reorder:duplicate_burst", 1);
+    state->copies = iniparser_getnonnegativeint(wr_options.output_options, "duplicate_reorder:copies", 1);
+    state->duplicate_delay = iniparser_getnonnegativeint(wr_options.output_options, "duplicate_reorder:duplicate_delay", 0) * WR_NSEC_PER_USEC;
+    state->reorder_probability = iniparser_getdouble(wr_options.output_options, "duplicate_reorder:reorder_probability", 0);
+    state->reorder_distance = iniparser_getnonnegativeint(wr_options.output_options, "duplicate_reorder:reorder_distance", 1);
+    if (state->duplicate_probability < 0)  state->duplicate_probability = 0;
+    if (state->duplicate_probability > 1)  state->duplicate_probability = 1;
+    if (state->reorder_probability < 0)  state->reorder_probability = 0;
+    if (state->reorder_probability > 1)  state->reorder_probability = 1;
+    if (state->duplicate_burst < 1)  state->duplicate_burst = 1;
+    if (state->copies < 1)  state->copies = 1;
+    if (state->reorder_distance < 1)  state->reorder_distance = 1;
+    if (state->copies > WR_DUPLICATE_MAX_COPIES || state->reorder_distance > WR_REORDER_MAX_DISTANCE){
+        wr_set_error("duplicate_reorder: copies or reorder_distance is too large");
+        return WR_FATAL;
+    }
+    /* a packet is held only if a slot is free, so up to reorder_distance packets are held at once */
+    state->held = calloc(state->reorder_distance, sizeof(wr_reorder_slot_t));
+    if (!state->held){
+        wr_set_error("cannot allocate slots of the duplicate_reorder filter");
+        return WR_FATAL;
+    }
+    if (log_filename && *log_filename && !(state->log = fopen(log_filename, "w"))){
+        wr_set_error("duplicate_reorder: cannot open log file");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Decide whether the packet starts or continues the burst of duplicates
+ */
+static int __duplicate(wr_duplicate_reorder_filter_state_t * state)
+{
+    if (state->duplicate_left){
+        state->duplicate_left--;
+        return 1;
+    }
+    if (state->duplicate_gap){
+        state->duplicate_gap--;
+        return 0;
+    }
+    /* burst starts, the next one starts after a geometric gap */
+    state->duplicate_left = wr_prng_geometric(&state->prng, 1 / state->duplicate_burst);
+    state->duplicate_gap = wr_prng_geometric(&state->prng, state->duplicate_probability);
+    return 1;
+}
+
+
+
+/**
+ * Process one packet.
+ * Packets which have to be sent are appended to out (metadata only, payload is shared),
+ * held packets released now are appended to released, their references are dropped after they are sent.
+ */
+static void __process(wr_duplicate_reorder_filter_state_t * state, wr_rtp_packet_t * packet,
+        wr_rtp_packet_t * out, int * out_count, wr_rtp_packet_t * released, int * released_count)
+{
+    int i, kept = 0;
+    state->packets++;
+    if (state->held_count < state->reorder_distance && state->reorder_probability > 0
+            && wr_prng_uniform(&state->prng) < state->reorder_probability){
+        wr_reorder_slot_t * slot = &state->held[state->held_count++];
+        wr_rtp_packet_share(&slot->packet, packet);
+        slot->remaining = wr_prng_uniform_int(&state->prng, 1, state->reorder_distance);
+        /* held packets are released in the order they were held, so no packet is overtaken by a later held one */
+        if (state->held_count > 1 && slot->remaining < state->held[state->held_count - 2].remaining)
+            slot->remaining = state->held[state->held_count - 2].remaining;
+        state->reordered++;
+        if (state->log)
+            fprintf(state->log, "%d\treorder\t%d\n", packet->sequence_number, slot->remaining);
+        return;
+    }
+
+    wr_rtp_packet_copy(&out[(*out_count)++], packet);
+    if (state->duplicate_probability > 0 && __duplicate(state)){
+        for (i=1; i<=state->copies; i++){
+            wr_rtp_packet_copy(&out[*out_count], packet);
+            out[(*out_count)++].lowlevel_timestamp += i * state->duplicate_delay;
+        }
+        state->duplicated++;
+        if (state->log)
+            fprintf(state->log, "%d\tduplicate\t%d\n", packet->sequence_number, state->copies);
+    }
+
+    /* held packets follow the packet which is sent */
+    for (i=0; i<state->held_count; i++){
+        wr_reorder_slot_t * slot = &state->held[i];
+        if (--slot->remaining == 0){
+            released[*released_count] = slot->packet;
+            wr_rtp_packet_copy(&out[*out_count], &released[(*released_count)++]);
+            if (out[*out_count].lowlevel_timestamp < packet->lowlevel_timestamp)
+                out[*out_count].lowlevel_timestamp = packet->lowlevel_timestamp;
+            (*out_count)++;
+        } else {
+            state->held[kept++] = *slot;
+        }
+    }
+    state->held_count = kept;
+}
+
+
+
+static void __send(wr_rtp_filter_t * filter, wr_rtp_packet_t * out, int out_count, wr_rtp_packet_t * released, int released_count)
+{
+    wr_rtp_packet_t * out_ptrs[out_count];
+    int i;
+    for (i=0; i<out_count; i++)
+        out_ptrs[i] = &out[i];
+    wr_rtp_filter_notify_observers_batch(filter, out_ptrs, out_count);
+    for (i=0; i<released_count; i++)
+        wr_rtp_packet_destroy(&released[i]);
+}
+
+
+
+/**
+ * Send packets which are still held in the order they were held
+ */
+static void __flush(wr_rtp_filter_t * filter, wr_duplicate_reorder_filter_state_t * state)
+{
+    wr_rtp_packet_t out[state->held_count + 1];
+    wr_rtp_packet_t released[state->held_count + 1];
+    int i, count = state->held_count;
+    for (i=0; i<count; i++){
+        released[i] = state->held[i].packet;
+        wr_rtp_packet_copy(&out[i], &released[i]);
+    }
+    state->held_count = 0;
+    if (count)
+        __send(filter, out, count, released, count);
+}
+
+
+
+static void __print_report(wr_duplicate_reorder_filter_state_t * state)
+{
+    fprintf(stderr, "duplicate_reorder: packets=%lu duplicated=%lu copies=%lu reordered=%lu\n",
+            state->packets, state->duplicated, state->duplicated * state->copies, state->reordered);
+}
+
+
+
+wr_errorcode_t wr_duplicate_reorder_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_duplicate_reorder_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the duplicate_reorder filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "duplicate_reorder:enabled", 1);
+            state->report = iniparser_getboolean(wr_options.output_options, "duplicate_reorder:report", 1);
+            if (state->enabled && (retval = __read_options(state)) != WR_OK){
+                /* packets pass unchanged */
+                state->enabled = 0;
+            }
+            wr_prng_stream_init(&state->prng);
+            state->duplicate_gap = wr_prng_geometric(&state->prng, state->duplicate_probability);
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_duplicate_reorder_filter_state_t * state = (wr_duplicate_reorder_filter_state_t * ) (filter->state);
+            wr_rtp_packet_t out[1 + WR_DUPLICATE_MAX_COPIES + state->held_count];
+            wr_rtp_packet_t released[state->held_count + 1];
+            int out_count = 0, released_count = 0;
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            __process(state, packet, out, &out_count, released, &released_count);
+            if (out_count)
+                __send(filter, out, out_count, released, released_count);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_duplicate_reorder_filter_state_t * state = (wr_duplicate_reorder_filter_state_t * ) (filter->state);
+            __flush(filter, state);
+            if (state->enabled && state->report)
+                __print_report(state);
+            if (state->log)
+                fclose(state->log);
+            free(state->held);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_duplicate_reorder_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_duplicate_reorder_filter_state_t * state = (wr_duplicate_reorder_filter_state_t * ) (filter->state);
+    /* each packet is sent with its copies, each held packet is released once */
+    wr_rtp_packet_t out[count * (1 + WR_DUPLICATE_MAX_COPIES) + state->held_count + count];
+    wr_rtp_packet_t released[state->held_count + count];
+    int i, out_count = 0, released_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    for (i=0; i<count; i++)
+        __process(state, packets[i], out, &out_count, released, &released_count);
+    if (out_count)
+        __send(filter, out, out_count, released, released_count);
+    return WR_OK;
+}
@@ -0,0 +1,112 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef DUPLICATE_REORDER_FILTER_H
+#define DUPLICATE_REORDER_FILTER_H
+#include <stdio.h>
+#include "rtpapi.h"
+#include "prng.h"
+
+/** @defgroup duplicate_reorder duplicate and reorder filter
+ * This filter duplicates packets and moves packets later in the stream by a bounded distance.
+ * Bursts of duplicated packets start with probability duplicate_probability, the mean number of
+ * packets in a burst is duplicate_burst, each of them is sent copies more times duplicate_delay
+ * microseconds one after another. A packet is held back with probability reorder_probability and
+ * sent after the next 1..reorder_distance packets (with the timestamp of the packet it follows).
+ * Up to reorder_distance packets are held at once, they are released in the order they were held,
+ * so a packet is overtaken by reorder_distance packets at most.
+ * It uses section [duplicate_reorder] of the configuration file "output.ini"
+ * There is following options
+ *
+ *    duplicate_probability = float from 0 to 1
+ *    duplicate_burst = float, not less than 1
+ *    copies = integer, from 1 to WR_DUPLICATE_MAX_COPIES
+ *    duplicate_delay = integer (microseconds)
+ *    reorder_probability = float from 0 to 1
+ *    reorder_distance = integer, from 1 to WR_REORDER_MAX_DISTANCE
+ *    log_filename = string, each duplicated and reordered packet is written to this file
+ *    report = boolean, print counters to stderr when the transmission is finished
+ *
+ * Duplicates and held packets share payload of the original packet, held packets are kept
+ * in slots allocated on TRANSMISSION_START.
+ *  @{
+ */
+
+/** Maximal number of copies of the duplicated packet */
+#define WR_DUPLICATE_MAX_COPIES 8
+/** Maximal distance of the reordering */
+#define WR_REORDER_MAX_DISTANCE 1024
+
+/** Packet which is held back */
+typedef struct __wr_reorder_slot {
+    wr_rtp_packet_t packet;             /**< reference to the payload of the packet */
+    int remaining;                      /**< number of packets which have to be sent before it */
+} wr_reorder_slot_t;
+
+/** 
+ * Structure to store internal state of the duplicate and reorder filter
+ */
+typedef struct __wr_duplicate_reorder_filter_state {
+    int enabled;
+    int report;
+    double duplicate_probability;
+    double duplicate_burst;
+    int copies;
+    wr_time_t duplicate_delay;          /**< (ns) */
+    double reorder_probability;
+    int reorder_distance;
+    uint64_t duplicate_gap;             /**< number of packets before the next burst of duplicates */
+    uint64_t duplicate_left;            /**< number of packets left in the current burst */
+    wr_reorder_slot_t * held;           /**< held packets in the order they were held */
+    int held_count;
+    FILE * log;
+    unsigned long packets;
+    unsigned long duplicated;
+    unsigned long reordered;
+    wr_prng_t prng;
+} wr_duplicate_reorder_filter_state_t;
+
+/**
+ * Duplicate and reorder packets of the input stream and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_duplicate_reorder_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_duplicate_reorder_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_duplicate_reorder_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "duplicate_reorder_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 20000
+#define COPIES 3
+#define DUPLICATE_DELAY (100 * WR_NSEC_PER_USEC)
+
+
+/**
+ * Check the received stream: each packet is received once or 1 + COPIES times (all copies share its payload
+ * and follow it with DUPLICATE_DELAY steps), no packet is lost and no packet moves more than distance positions
+ * in the stream of first copies
+ * @param duplicated number of duplicated packets
+ * @param moved number of packets which are received out of order
+ */
+static int check_stream(wr_rtp_filter_t * sink, wr_rtp_packet_t * packets, int distance, int * duplicated, int * moved)
+{
+    static int counts[PACKETS];
+    static const uint8_t * payloads[PACKETS];
+    static wr_time_t timestamps[PACKETS];
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    int position = 0;
+    size_t i;
+    ASSERT(state->finished, "transmission is not finished");
+    for (i = 0; i < PACKETS; i++)
+        counts[i] = 0;
+    *duplicated = *moved = 0;
+    for (i = 0; i < state->count; i++){
+        wr_test_record_t * record = &state->records[i];
+        int seq = record->sequence_number;
+        ASSERT(seq >= 0 && seq < PACKETS, "unknown packet %d", seq);
+        if (counts[seq]++ == 0){
+            ASSERT(record->payload == wr_rtp_packet_payload(&packets[seq]), "payload of packet %d is not shared", seq);
+            ASSERT(abs(position - seq) <= distance, "packet %d is received at position %d", seq, position);
+            if (position != seq)
+                (*moved)++;
+            position++;
+        } else {
+            ASSERT(record->payload == payloads[seq], "payload of the copy of packet %d is not shared", seq);
+            ASSERT(record->lowlevel_timestamp == timestamps[seq] + DUPLICATE_DELAY, "copy %d of packet %d is sent at %lld ns",
+                    counts[seq] - 1, seq, (long long)record->lowlevel_timestamp);
+        }
+        payloads[seq] = record->payload;
+        timestamps[seq] = record->lowlevel_timestamp;
+    }
+    for (i = 0; i < PACKETS; i++){
+        ASSERT(counts[i] == 1 || counts[i] == 1 + COPIES, "packet %u is received %d times", (unsigned)i, counts[i]);
+        if (counts[i] > 1)
+            (*duplicated)++;
+    }
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t filter, sink;
+    static wr_rtp_packet_t packets[PACKETS];
+    int batch_sizes[] = {1, WR_MAX_BATCH_SIZE};
+    int distances[] = {1, 3, 16, WR_REORDER_MAX_DISTANCE};
+    int duplicated, moved;
+    size_t i, b, d;
+
+    CHECK( wr_test_options_init("duplicate_reorder_test") );
+    CHECK( wr_test_set_option("duplicate_reorder:enabled=true") );
+    CHECK( wr_test_set_option("duplicate_reorder:report=false") );
+    CHECK( wr_test_set_option("duplicate_reorder:copies=3") );
+    CHECK( wr_test_set_option("duplicate_reorder:duplicate_delay=100") );
+    wr_prng_seed(1);
+    wr_test_sink_create(&sink, PACKETS * (1 + COPIES));
+    wr_test_filter_create(&filter, "duplicate_reorder", &wr_duplicate_reorder_filter_notify, &wr_duplicate_reorder_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++)
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, i * 20 * WR_NSEC_PER_MSEC) );
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* all packets are duplicated */
+        CHECK( wr_test_set_option("duplicate_reorder:duplicate_probability=1") );
+        CHECK( wr_test_set_option("duplicate_reorder:reorder_probability=0") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        ASSERT(wr_test_sink_state(&sink)->count == PACKETS * (1 + COPIES), "%u packets are received",
+                (unsigned)wr_test_sink_state(&sink)->count);
+        if (check_stream(&sink, packets, 0, &duplicated, &moved))
+            return 1;
+        ASSERT(duplicated == PACKETS, "%d packets are duplicated", duplicated);
+
+        /* bursts of duplicates */
+        CHECK( wr_test_set_option("duplicate_reorder:duplicate_probability=0.05") );
+        CHECK( wr_test_set_option("duplicate_reorder:duplicate_burst=3") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        if (check_stream(&sink, packets, 0, &duplicated, &moved))
+            return 1;
+        ASSERT(duplicated > 0 && duplicated < PACKETS, "%d packets are duplicated", duplicated);
+
+        /* reordering alone and with duplicates: held packets are not lost, they are overtaken by distance packets at most */
+        for (d = 0; d < sizeof(distances) / sizeof(distances[0]); d++){
+            char option[64];
+            snprintf(option, sizeof(option), "duplicate_reorder:reorder_distance=%d", distances[d]);
+            CHECK( wr_test_set_option(option) );
+            CHECK( wr_test_set_option("duplicate_reorder:duplicate_probability=0") );
+            CHECK( wr_test_set_option("duplicate_reorder:reorder_probability=0.3") );
+            CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+            ASSERT(wr_test_sink_state(&sink)->count == PACKETS, "%u packets are received", (unsigned)wr_test_sink_state(&sink)->count);
+            if (check_stream(&sink, packets, distances[d], &duplicated, &moved))
+                return 1;
+            ASSERT(duplicated == 0 && moved > 0, "%d packets are duplicated, %d are moved", duplicated, moved);
+
+            CHECK( wr_test_set_option("duplicate_reorder:duplicate_probability=0.05") );
+            CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+            if (check_stream(&sink, packets, distances[d], &duplicated, &moved))
+                return 1;
+            ASSERT(duplicated > 0 && moved > 0, "%d packets are duplicated, %d are moved", duplicated, moved);
+        }
+    }
+
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -32,7 +32,6 @@
  *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  */
-#include "contrib/ranlib/ranlib.h"
 #include "misc.h"
 #include "gamma_delay_filter.h"
 
@@ -47,21 +46,22 @@ wr_errorcode_t wr_gamma_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_t
             state->enabled = iniparser_getboolean(wr_options.output_options, "gamma_delay:enabled", 1);
             state->shape = iniparser_getpositiveint(wr_options.output_options, "gamma_delay:shape", 0);
             state->scale = iniparser_getpositiveint(wr_options.output_options, "gamma_delay:scale", 0);
+            wr_prng_stream_init(&state->prng);
             filter->state = (void*)state;
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
         case NEW_PACKET: {
             wr_gamma_delay_filter_state_t * state = (wr_gamma_delay_filter_state_t * ) (filter->state);
-            int delay;
+            wr_time_t delay;
             if (!state->enabled){
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            delay =  (int)gengam(1/(float)state->scale, state->shape);
+            delay =  (wr_time_t)(wr_prng_gamma(&state->prng, state->shape, state->scale) * WR_NSEC_PER_USEC);
             wr_rtp_packet_t new_packet;
             wr_rtp_packet_copy(&new_packet, packet);
-            timeval_increment(&new_packet.lowlevel_timestamp, delay);
+            new_packet.lowlevel_timestamp += delay;
             wr_rtp_filter_notify_observers(filter, event, &new_packet);
             return WR_OK;
         }
@@ -72,3 +72,26 @@ wr_errorcode_t wr_gamma_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_t
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_gamma_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_gamma_delay_filter_state_t * state = (wr_gamma_delay_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    double delays[count];
+    int i;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    wr_prng_fill_gamma(&state->prng, state->shape, state->scale, delays, count);
+    for (i=0; i<count; i++){
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        new_packets[i].lowlevel_timestamp += (wr_time_t)(delays[i] * WR_NSEC_PER_USEC);
+        new_packets_ptrs[i] = &new_packets[i];
+    }
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, count);
+    return WR_OK;
+}
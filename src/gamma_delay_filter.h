@@ -35,6 +35,7 @@
 #ifndef GAMMA_DELAY_FILTER_H
 #define GAMMA_DELAY_FILTER_H
 #include "rtpapi.h"
+#include "prng.h"
 
 /** @defgroup gamma_delay gamma delay filter
  * This filter emulates independent delays of the packets using gamma 
@@ -57,6 +58,7 @@ typedef struct __wr_gamma_delay_filter_state {
     int enabled;
     int shape;
     int scale;
+    wr_prng_t prng;
 } wr_gamma_delay_filter_state_t;
 
 /**
@@ -64,6 +66,11 @@ typedef struct __wr_gamma_delay_filter_state {
  * This method is invoked when filter is notified.
  */
 wr_errorcode_t wr_gamma_delay_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_gamma_delay_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_gamma_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
 /** @} */
 
 #endif
@@ -0,0 +1,234 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "gilbert_elliott_filter.h"
+
+
+
+static double __clamp(double value)
+{
+    if (value < 0)  return 0;
+    if (value > 1)  return 1;
+    return value;
+}
+
+
+
+/**
+ * Fraction of packets in the bad state in the steady state
+ */
+static double __bad_share(wr_gilbert_elliott_filter_state_t * state)
+{
+    return (state->p + state->r > 0) ? state->p / (state->p + state->r) : 0;
+}
+
+
+
+/**
+ * Read parameters of the model, either p, r, k, h or burst_length and loss_rate with k and h
+ */
+static wr_errorcode_t __read_options(wr_gilbert_elliott_filter_state_t * state)
+{
+    double burst_length = iniparser_getdouble(wr_options.output_options, "gilbert_elliott:burst_length", 0);
+    state->loss_good = 1 - __clamp(iniparser_getdouble(wr_options.output_options, "gilbert_elliott:k", 1));
+    state->loss_bad = 1 - __clamp(iniparser_getdouble(wr_options.output_options, "gilbert_elliott:h", 0));
+    if (burst_length > 0){
+        double loss_rate = __clamp(iniparser_getdouble(wr_options.output_options, "gilbert_elliott:loss_rate", 0));
+        double bad_share;
+        if (burst_length < 1 || state->loss_bad <= state->loss_good){
+            wr_set_error("gilbert_elliott: burst_length has to be not less than 1 and h has to be less than k");
+            return WR_FATAL;
+        }
+        /* loss_rate = bad_share * loss_bad + (1 - bad_share) * loss_good */
+        bad_share = (loss_rate - state->loss_good) / (state->loss_bad - state->loss_good);
+        state->r = 1 / burst_length;
+        state->p = (bad_share < 1) ? state->r * bad_share / (1 - bad_share) : 2;
+        if (bad_share < 0 || state->p > 1){
+            wr_set_error("gilbert_elliott: loss_rate can not be reached with given burst_length, k and h");
+            return WR_FATAL;
+        }
+    } else {
+        state->p = __clamp(iniparser_getdouble(wr_options.output_options, "gilbert_elliott:p", 0));
+        state->r = __clamp(iniparser_getdouble(wr_options.output_options, "gilbert_elliott:r", 0));
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Draw length of the stay in the current state and the gap before the next loss
+ */
+static void __enter_state(wr_gilbert_elliott_filter_state_t * state)
+{
+    state->dwell = wr_prng_geometric(&state->prng, state->bad ? state->r : state->p);
+    if (state->dwell != UINT64_MAX)
+        state->dwell++;
+    state->gap = wr_prng_geometric(&state->prng, state->bad ? state->loss_bad : state->loss_good);
+}
+
+
+
+/**
+ * Decide whether the next packet is lost
+ */
+static int __next_lost(wr_gilbert_elliott_filter_state_t * state)
+{
+    int lost;
+    if (!state->dwell){
+        state->bad = !state->bad;
+        __enter_state(state);
+    }
+    state->dwell--;
+    if (state->gap){
+        state->gap--;
+        lost = 0;
+    } else {
+        state->gap = wr_prng_geometric(&state->prng, state->bad ? state->loss_bad : state->loss_good);
+        lost = 1;
+    }
+    state->packets++;
+    if (state->bad)
+        state->bad_packets++;
+    if (lost){
+        state->lost++;
+        if (!state->prev_lost)
+            state->bursts++;
+    }
+    state->prev_lost = lost;
+    return lost;
+}
+
+
+
+static void __print_report(wr_gilbert_elliott_filter_state_t * state)
+{
+    double bad_share = __bad_share(state);
+    fprintf(stderr, "gilbert_elliott: packets=%lu lost=%lu loss_rate=%.6f (expected %.6f) "
+            "bursts=%lu mean_burst_length=%.3f bad_state=%.6f (expected %.6f)\n",
+            state->packets, state->lost, state->packets ? (double)state->lost / state->packets : 0,
+            bad_share * state->loss_bad + (1 - bad_share) * state->loss_good,
+            state->bursts, state->bursts ? (double)state->lost / state->bursts : 0,
+            state->packets ? (double)state->bad_packets / state->packets : 0, bad_share);
+}
+
+
+
+wr_errorcode_t wr_gilbert_elliott_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_gilbert_elliott_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the gilbert_elliott filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "gilbert_elliott:enabled", 1);
+            state->report = iniparser_getboolean(wr_options.output_options, "gilbert_elliott:report", 1);
+            if (state->enabled && (retval = __read_options(state)) != WR_OK){
+                /* packets pass without losses */
+                state->enabled = 0;
+            }
+            filter->state = (void*)state;
+            wr_prng_stream_init(&state->prng);
+            /* the first state is drawn from the steady state distribution */
+            state->bad = wr_prng_uniform(&state->prng) < __bad_share(state);
+            __enter_state(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_gilbert_elliott_filter_state_t * state = (wr_gilbert_elliott_filter_state_t * ) (filter->state);
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            if (!__next_lost(state)){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+            }
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_gilbert_elliott_filter_state_t * state = (wr_gilbert_elliott_filter_state_t * ) (filter->state);
+            if (state->enabled && state->report)
+                __print_report(state);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_gilbert_elliott_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_gilbert_elliott_filter_state_t * state = (wr_gilbert_elliott_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t * passed[count];
+    int i = 0, passed_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    while (i < count){
+        /* packets which are received in the current state are skipped at once */
+        int run = count - i;
+        if (state->dwell < (uint64_t)run)
+            run = (int)state->dwell;
+        if (state->gap < (uint64_t)run)
+            run = (int)state->gap;
+        if (run){
+            memcpy(&passed[passed_count], &packets[i], run * sizeof(*passed));
+            passed_count += run;
+            state->dwell -= run;
+            state->gap -= run;
+            state->packets += run;
+            if (state->bad)
+                state->bad_packets += run;
+            state->prev_lost = 0;
+            i += run;
+        } else {
+            if (!__next_lost(state))
+                passed[passed_count++] = packets[i];
+            i++;
+        }
+    }
+    wr_rtp_filter_notify_observers_batch(filter, passed, passed_count);
+    return WR_OK;
+}
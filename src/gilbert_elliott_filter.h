@@ -0,0 +1,97 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef GILBERT_ELLIOTT_FILTER_H
+#define GILBERT_ELLIOTT_FILTER_H
+#include "rtpapi.h"
+#include "prng.h"
+
+/** @defgroup gilbert_elliott Gilbert-Elliott losses filter
+ * This filter emulates burst losses with the Gilbert-Elliott model.
+ * The channel is either in the good or in the bad state, the state changes before each packet
+ * with probability p (good to bad) or r (bad to good). A packet is received with probability k
+ * in the good state and with probability h in the bad state.
+ * It uses section [gilbert_elliott] of the configuration file "output.ini"
+ * There is four used options
+ *
+ *    p = float from 0 to 1
+ *    r = float from 0 to 1
+ *    k = float from 0 to 1 (default 1)
+ *    h = float from 0 to 1 (default 0)
+ *
+ * If burst_length (mean number of packets in the bad state, not less than 1) is given,
+ * p and r are computed from it and from the mean loss_rate instead.
+ * When the transmission is finished, the filter prints the realized statistics to stderr
+ * (unless report = false).
+ *
+ * Lengths of the stays in each state and gaps between losses are drawn from the geometric
+ * distribution, so the filter does not draw a random number per packet.
+ *  @{
+ */
+
+
+/** 
+ * Structure to store internal state of the Gilbert-Elliott filter
+ */
+typedef struct __wr_gilbert_elliott_filter_state {
+    int enabled;
+    int report;
+    double p;                           /**< probability of the transition from the good state to the bad one */
+    double r;                           /**< probability of the transition from the bad state to the good one */
+    double loss_good;                   /**< loss probability in the good state (1 - k) */
+    double loss_bad;                    /**< loss probability in the bad state (1 - h) */
+    int bad;                            /**< current state is bad */
+    uint64_t dwell;                     /**< number of packets left in the current state */
+    uint64_t gap;                       /**< number of packets which pass before the next loss */
+    int prev_lost;
+    unsigned long packets;              /**< number of received packets */
+    unsigned long lost;                 /**< number of lost packets */
+    unsigned long bursts;               /**< number of series of consecutive losses */
+    unsigned long bad_packets;          /**< number of packets received in the bad state */
+    wr_prng_t prng;
+} wr_gilbert_elliott_filter_state_t;
+
+/**
+ * Loss random data from input stream and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_gilbert_elliott_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_gilbert_elliott_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_gilbert_elliott_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
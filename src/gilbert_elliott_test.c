@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <math.h>
+#include "gilbert_elliott_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 400000
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t filter, sink;
+    wr_gilbert_elliott_filter_state_t * state;
+    double loss_rate, burst_length;
+    int batch_sizes[] = {1, WR_MAX_BATCH_SIZE};
+    size_t b;
+
+    CHECK( wr_test_options_init("gilbert_elliott_test") );
+    CHECK( wr_test_set_option("gilbert_elliott:enabled=true") );
+    CHECK( wr_test_set_option("gilbert_elliott:report=false") );
+    wr_prng_seed(1);
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&filter, "gilbert_elliott", &wr_gilbert_elliott_filter_notify, &wr_gilbert_elliott_filter_notify_batch, &sink);
+
+    /* Gilbert model (k = 1, h = 0): all packets of the bad state are lost, bursts are the stays in the bad state */
+    CHECK( wr_test_set_option("gilbert_elliott:burst_length=4") );
+    CHECK( wr_test_set_option("gilbert_elliott:loss_rate=0.05") );
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        CHECK( wr_test_transmit_sequence(&filter, PACKETS, batch_sizes[b]) );
+        wr_test_sink_losses(&sink, PACKETS, &loss_rate, &burst_length);
+        ASSERT(fabs(loss_rate - 0.05) < 0.05 * 0.05, "loss rate is %f instead of 0.05", loss_rate);
+        ASSERT(fabs(burst_length - 4) < 0.05 * 4, "mean burst length is %f instead of 4", burst_length);
+    }
+
+    /* losses in both states: r = 1 / burst_length, p follows from the share of the bad state */
+    CHECK( wr_test_set_option("gilbert_elliott:burst_length=8") );
+    CHECK( wr_test_set_option("gilbert_elliott:loss_rate=0.1") );
+    CHECK( wr_test_set_option("gilbert_elliott:k=0.99") );
+    CHECK( wr_test_set_option("gilbert_elliott:h=0.3") );
+    {
+        double bad_share = (0.1 - 0.01) / (0.7 - 0.01);
+        CHECK( wr_gilbert_elliott_filter_notify(&filter, TRANSMISSION_START, NULL) );
+        state = (wr_gilbert_elliott_filter_state_t *)filter.state;
+        ASSERT(state->enabled, "filter is disabled");
+        ASSERT(fabs(state->r - 1.0 / 8) < 1e-12, "r is %f instead of %f", state->r, 1.0 / 8);
+        ASSERT(fabs(state->p - bad_share / (1 - bad_share) / 8) < 1e-12, "p is %f instead of %f", state->p, bad_share / (1 - bad_share) / 8);
+        CHECK( wr_gilbert_elliott_filter_notify(&filter, TRANSMISSION_END, NULL) );
+    }
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        CHECK( wr_test_transmit_sequence(&filter, PACKETS, batch_sizes[b]) );
+        wr_test_sink_losses(&sink, PACKETS, &loss_rate, &burst_length);
+        ASSERT(fabs(loss_rate - 0.1) < 0.05 * 0.1, "loss rate is %f instead of 0.1", loss_rate);
+    }
+
+    /* loss rate which needs p > 1: the filter reports the error and passes all packets */
+    CHECK( wr_test_set_option("gilbert_elliott:burst_length=1") );
+    CHECK( wr_test_set_option("gilbert_elliott:loss_rate=0.6") );
+    ASSERT(wr_test_transmit_sequence(&filter, 1000, 1) == WR_FATAL, "unreachable loss rate is accepted");
+    ASSERT(wr_test_sink_state(&sink)->count == 1000, "disabled filter loses packets");
+
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -33,9 +33,20 @@
  *
  */
 #include <sys/time.h>
+#include <string.h>
 #include "independent_losses_filter.h"
 
 
+
+/**
+ * Draw number of packets which pass before the next loss
+ */
+static void __draw_gap(wr_independent_losses_filter_state_t * state)
+{
+    state->gap = wr_prng_geometric(&state->prng, state->loss_rate);
+}
+
+
 wr_errorcode_t wr_independent_losses_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
 {
     switch(event){
@@ -46,22 +57,24 @@ wr_errorcode_t wr_independent_losses_filter_notify(wr_rtp_filter_t * filter, wr_
             state->loss_rate = iniparser_getdouble(wr_options.output_options, "independent_losses:loss_rate", 0);
             if (state->loss_rate < 0 )  state->loss_rate = 0;
             if (state->loss_rate > 1 )  state->loss_rate = 1;             
+            wr_prng_stream_init(&state->prng);
+            __draw_gap(state);
             filter->state = (void*)state;
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
         case NEW_PACKET: {
-            double rand_val;
             wr_independent_losses_filter_state_t * state = (wr_independent_losses_filter_state_t * ) (filter->state);
             if (!state->enabled){
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            int lost;
-            rand_val = (double) rand() / RAND_MAX;
-            lost = (rand_val < state->loss_rate) ? 1 : 0;
-            if (!lost){
+            if (state->gap){
+                state->gap--;
                 wr_rtp_filter_notify_observers(filter, event, packet);
+            } else {
+                /* the packet is lost */
+                __draw_gap(state);
             }
             return WR_OK;
         }
@@ -73,3 +86,38 @@ wr_errorcode_t wr_independent_losses_filter_notify(wr_rtp_filter_t * filter, wr_
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_independent_losses_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_independent_losses_filter_state_t * state = (wr_independent_losses_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t * passed[count];
+    int i = 0, passed_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    if (state->gap >= (uint64_t)count){
+        /* no losses in this batch */
+        state->gap -= count;
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    while (i < count){
+        int run = count - i;
+        if (state->gap < (uint64_t)run)
+            run = (int)state->gap;
+        memcpy(&passed[passed_count], &packets[i], run * sizeof(*passed));
+        passed_count += run;
+        state->gap -= run;
+        i += run;
+        if (i < count){
+            /* packets[i] is lost */
+            i++;
+            __draw_gap(state);
+        }
+    }
+    wr_rtp_filter_notify_observers_batch(filter, passed, passed_count);
+    return WR_OK;
+}
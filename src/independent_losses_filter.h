@@ -35,12 +35,16 @@
 #ifndef INDEPENDENT_LOSSES_FILTER_H
 #define INDEPENDENT_LOSSES_FILTER_H
 #include "rtpapi.h"
+#include "prng.h"
 
 /** @defgroup independent_losses independent losses filter
  * This filter emulates independent random losses.
  * It uses section [independent_losses] of the configuration file "output.ini"
  * There is one used option
  * loss_rate = float from 0 to 1
+ *
+ * Instead of one random number per packet the filter draws the number of packets between
+ * losses from the geometric distribution, so packets between losses cost nothing.
  *  @{
  */
 
@@ -51,6 +55,8 @@
 typedef struct __wr_independent_losses_filter_state {
     int enabled;
     double loss_rate;
+    uint64_t gap;                       /**< number of packets which pass before the next loss */
+    wr_prng_t prng;
 } wr_independent_losses_filter_state_t;
 
 /**
@@ -58,6 +64,11 @@ typedef struct __wr_independent_losses_filter_state {
  * This method is invoked when filter is notified.
  */
 wr_errorcode_t wr_independent_losses_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_independent_losses_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_independent_losses_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
 /** @} */
 
 #endif
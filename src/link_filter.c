@@ -0,0 +1,317 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcap_filter.h"
+#include "link_filter.h"
+
+/** Initial capacity of the queue (packets) */
+#define WR_LINK_QUEUE_CAPACITY 256
+
+
+
+/**
+ * Read bit rate (bits per second) as bytes per nanosecond
+ */
+static double __get_rate(const char * key)
+{
+    double rate = iniparser_getdouble(wr_options.output_options, (char *)key, 0);
+    return (rate > 0) ? rate / 8 / WR_NSEC_PER_SEC : 0;
+}
+
+
+
+static wr_errorcode_t __read_options(wr_link_filter_state_t * state)
+{
+    double cross_traffic = __get_rate("link:cross_traffic");
+    state->rate = __get_rate("link:rate");
+    if (state->rate == 0){
+        /* link is not emulated, packets pass unchanged */
+        state->enabled = 0;
+        return WR_OK;
+    }
+    state->line_rate = __get_rate("link:line_rate");
+    if (state->line_rate == 0)
+        state->line_rate = state->rate;
+    state->burst = iniparser_getnonnegativeint(wr_options.output_options, "link:burst", 0);
+    state->latency = iniparser_getnonnegativeint(wr_options.output_options, "link:latency", 0) * WR_NSEC_PER_USEC;
+    state->overhead = iniparser_getnonnegativeint(wr_options.output_options, "link:overhead", 0);
+    state->queue_size = iniparser_getnonnegativeint(wr_options.output_options, "link:queue_size", 65536);
+    state->queue_packets = iniparser_getnonnegativeint(wr_options.output_options, "link:queue_packets", 0);
+    state->red = strcmp(iniparser_getstring(wr_options.output_options, "link:aqm", "taildrop"), "red") == 0;
+    state->red_min = iniparser_getnonnegativeint(wr_options.output_options, "link:red_min", state->queue_size / 4);
+    state->red_max = iniparser_getnonnegativeint(wr_options.output_options, "link:red_max", state->queue_size * 3 / 4);
+    state->red_probability = iniparser_getdouble(wr_options.output_options, "link:red_probability", 0.1);
+    state->red_weight = iniparser_getdouble(wr_options.output_options, "link:red_weight", 0.002);
+    if (cross_traffic >= state->rate || cross_traffic >= state->line_rate){
+        wr_set_error("link: cross_traffic has to be less than the rate of the link");
+        return WR_FATAL;
+    }
+    if (state->red && state->red_max <= state->red_min){
+        wr_set_error("link: red_max has to be greater than red_min");
+        return WR_FATAL;
+    }
+    /* the rest of the capacity is left for the packets */
+    state->rate -= cross_traffic;
+    state->line_rate -= cross_traffic;
+    state->tokens = state->burst;
+    state->capacity = WR_LINK_QUEUE_CAPACITY;
+    state->queue = malloc(state->capacity * sizeof(wr_link_entry_t));
+    if (!state->queue){
+        wr_set_error("cannot allocate queue of the link filter");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Remove packets which are sent before the time
+ */
+static void __dequeue(wr_link_filter_state_t * state, wr_time_t time)
+{
+    while (state->count && state->queue[state->head].departure <= time){
+        state->queued_bytes -= state->queue[state->head].size;
+        state->head = (state->head + 1) % state->capacity;
+        state->count--;
+    }
+}
+
+
+
+/**
+ * Make room for one more packet in the queue
+ */
+static wr_errorcode_t __reserve(wr_link_filter_state_t * state)
+{
+    if (state->count == state->capacity){
+        int capacity = 2 * state->capacity;
+        wr_link_entry_t * queue = malloc(capacity * sizeof(wr_link_entry_t));
+        int i;
+        if (!queue){
+            wr_set_error("cannot allocate queue of the link filter");
+            return WR_FATAL;
+        }
+        for (i=0; i<state->count; i++)
+            queue[i] = state->queue[(state->head + i) % state->capacity];
+        free(state->queue);
+        state->queue = queue;
+        state->capacity = capacity;
+        state->head = 0;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Append the packet to the queue, the room is reserved by #__reserve
+ */
+static void __enqueue(wr_link_filter_state_t * state, wr_time_t departure, size_t size)
+{
+    state->queue[(state->head + state->count) % state->capacity].departure = departure;
+    state->queue[(state->head + state->count) % state->capacity].size = size;
+    state->count++;
+    state->queued_bytes += size;
+    if (state->queued_bytes > state->max_queued_bytes)
+        state->max_queued_bytes = state->queued_bytes;
+    if (state->count > state->max_queued_packets)
+        state->max_queued_packets = state->count;
+}
+
+
+
+/**
+ * Decide whether the arriving packet is dropped
+ */
+static int __drop(wr_link_filter_state_t * state, size_t size)
+{
+    if (state->red)
+        state->average += state->red_weight * (state->queued_bytes - state->average);
+    if (state->queued_bytes + size > state->queue_size || (state->queue_packets && state->count >= state->queue_packets)){
+        state->tail_drops++;
+        return 1;
+    }
+    if (state->red){
+        if (state->average >= state->red_max
+                || (state->average > state->red_min
+                    && wr_prng_uniform(&state->prng) < state->red_probability * (state->average - state->red_min) / (state->red_max - state->red_min))){
+            state->red_drops++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
+/**
+ * Send the packet through the link
+ * @param passed is set to 0 if the packet is dropped
+ * @return WR_FATAL if the queue cannot grow (the packet is not accounted then)
+ */
+static wr_errorcode_t __transmit(wr_link_filter_state_t * state, wr_rtp_packet_t * packet, int * passed)
+{
+    wr_time_t arrival = packet->lowlevel_timestamp;
+    wr_time_t start;
+    size_t size = wr_pcap_frame_size(packet) + state->overhead;
+
+    *passed = 0;
+    __dequeue(state, arrival);
+    if (__reserve(state) != WR_OK)
+        return WR_FATAL;
+    state->packets++;
+    state->sum_queued_bytes += state->queued_bytes;
+    if (__drop(state, size))
+        return WR_OK;
+
+    /* FIFO: transmission starts when the previous packet is sent */
+    start = (arrival > state->last_departure) ? arrival : state->last_departure;
+    if (state->burst > 0){
+        /* wait for tokens, bucket may be smaller than a large packet */
+        double depth = (state->burst > size) ? state->burst : size;
+        state->tokens += (start - state->updated) * state->rate;
+        if (state->tokens > depth)
+            state->tokens = depth;
+        if (state->tokens < size){
+            start += (wr_time_t)((size - state->tokens) / state->rate + 0.5);
+            state->tokens = size;
+        }
+        state->tokens -= size;
+        state->updated = start;
+    }
+    state->last_departure = start + (wr_time_t)(size / state->line_rate + 0.5);
+    __enqueue(state, state->last_departure, size);
+
+    packet->lowlevel_timestamp = state->last_departure + state->latency;
+    state->sum_delay += packet->lowlevel_timestamp - arrival;
+    if (packet->lowlevel_timestamp - arrival > state->max_delay)
+        state->max_delay = packet->lowlevel_timestamp - arrival;
+    *passed = 1;
+    return WR_OK;
+}
+
+
+
+static void __print_report(wr_link_filter_state_t * state)
+{
+    unsigned long sent = state->packets - state->tail_drops - state->red_drops;
+    fprintf(stderr, "link: packets=%lu sent=%lu tail_drops=%lu red_drops=%lu "
+            "mean_queue=%.1f max_queue=%lu bytes/%d packets mean_delay=%.3f max_delay=%.3f ms\n",
+            state->packets, sent, state->tail_drops, state->red_drops,
+            state->packets ? state->sum_queued_bytes / state->packets : 0,
+            (unsigned long)state->max_queued_bytes, state->max_queued_packets,
+            sent ? state->sum_delay / sent / WR_NSEC_PER_MSEC : 0,
+            (double)state->max_delay / WR_NSEC_PER_MSEC);
+}
+
+
+
+wr_errorcode_t wr_link_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_link_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the link filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "link:enabled", 1);
+            state->report = iniparser_getboolean(wr_options.output_options, "link:report", 1);
+            /* stream is taken even if RED is not used, so streams of the following filters do not depend on options */
+            wr_prng_stream_init(&state->prng);
+            if (state->enabled && (retval = __read_options(state)) != WR_OK){
+                /* packets pass unchanged */
+                state->enabled = 0;
+            }
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_link_filter_state_t * state = (wr_link_filter_state_t * ) (filter->state);
+            wr_rtp_packet_t new_packet;
+            int passed;
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            wr_rtp_packet_copy(&new_packet, packet);
+            if (__transmit(state, &new_packet, &passed) != WR_OK)
+                return WR_FATAL;
+            if (passed)
+                wr_rtp_filter_notify_observers(filter, event, &new_packet);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_link_filter_state_t * state = (wr_link_filter_state_t * ) (filter->state);
+            if (state->enabled && state->report)
+                __print_report(state);
+            free(state->queue);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_link_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_link_filter_state_t * state = (wr_link_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    wr_errorcode_t retval = WR_OK;
+    int i, passed, passed_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    for (i=0; i<count && retval == WR_OK; i++){
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        retval = __transmit(state, &new_packets[i], &passed);
+        if (retval == WR_OK && passed)
+            new_packets_ptrs[passed_count++] = &new_packets[i];
+    }
+    /* packets sent before the error are passed anyway */
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, passed_count);
+    return retval;
+}
@@ -0,0 +1,129 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef LINK_FILTER_H
+#define LINK_FILTER_H
+#include <stddef.h>
+#include "rtpapi.h"
+#include "prng.h"
+#include "misc.h"
+
+/** @defgroup link_filter link filter
+ * This filter emulates the bottleneck link: packets are queued in the FIFO queue of limited size
+ * and sent with the given rate, so they are delayed by queueing and serialization or dropped
+ * when the queue is full. Size of each packet is the size of its ETH + IP + UDP + RTP frame
+ * (the same as in the pcap file) plus the given overhead.
+ * It uses section [link] of the configuration file "output.ini"
+ * There is following options:
+ *
+ *    rate = float, rate of the link (bits per second), 0 means that the link is not emulated
+ *    burst = integer, size of the token bucket (bytes), 0 means that the link sends with its rate
+ *    line_rate = float, rate of the serialization if the token bucket is used (default is rate)
+ *    cross_traffic = float, constant load of the link by other traffic (bits per second)
+ *    latency = integer, propagation delay (microseconds)
+ *    overhead = integer, bytes added to each frame (preamble, FCS, gap)
+ *    queue_size = integer, size of the queue (bytes)
+ *    queue_packets = integer, maximal number of packets in the queue (0 means no limit)
+ *    aqm = taildrop | red
+ *    red_min, red_max = integer, thresholds of the average queue size (bytes)
+ *    red_probability = float, drop probability at red_max
+ *    red_weight = float, weight of the average queue size
+ *    report = boolean, print statistics of the queue when the transmission is finished
+ *
+ * Cross traffic is a fluid load, it reduces the rate available for the packets.
+ * Packets have to come in the order of their timestamps, so the filter is placed after the sort
+ * or scheduler filter.
+ * The queue keeps only departure times and sizes of the queued packets, each packet costs O(1).
+ *  @{
+ */
+
+/** Packet in the queue of the link */
+typedef struct __wr_link_entry {
+    wr_time_t departure;                /**< time when the last bit of the packet is sent */
+    size_t size;                        /**< size of the frame */
+} wr_link_entry_t;
+
+/** 
+ * Structure to store internal state of the link filter
+ */
+typedef struct __wr_link_filter_state {
+    int enabled;
+    int report;
+    double rate;                        /**< bytes per nanosecond available for the packets (token rate) */
+    double line_rate;                   /**< bytes per nanosecond of the serialization */
+    double burst;                       /**< size of the token bucket (bytes), 0 if it is not used */
+    wr_time_t latency;                  /**< propagation delay (ns) */
+    size_t overhead;
+    size_t queue_size;                  /**< limit of the queue (bytes) */
+    int queue_packets;                  /**< limit of the queue (packets), 0 if it is not limited */
+    int red;                            /**< use RED instead of the tail drop */
+    double red_min;
+    double red_max;
+    double red_probability;
+    double red_weight;
+    double average;                     /**< RED: average size of the queue (bytes) */
+
+    double tokens;                      /**< tokens in the bucket at the time "updated" */
+    wr_time_t updated;
+    wr_time_t last_departure;           /**< when the link sends the last queued packet */
+    wr_link_entry_t * queue;            /**< ring buffer of the queued packets */
+    int capacity;
+    int head;
+    int count;
+    size_t queued_bytes;
+
+    unsigned long packets;              /**< number of received packets */
+    unsigned long tail_drops;
+    unsigned long red_drops;
+    size_t max_queued_bytes;
+    int max_queued_packets;
+    double sum_queued_bytes;            /**< to compute the mean queue size seen by the arriving packets */
+    double sum_delay;                   /**< sum of the delays of the sent packets (ns) */
+    wr_time_t max_delay;
+    wr_prng_t prng;                     /**< stream of the filter, used only by RED */
+} wr_link_filter_state_t;
+
+/**
+ * Queue, delay or drop packets of the input stream and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_link_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_link_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_link_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "link_filter.h"
+#include "pcap_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 2000
+/* 100-byte frames on the link of 1 Mbit/s: each frame is sent in 800 us */
+#define FRAME_SIZE 100
+#define SERVICE_TIME (800 * WR_NSEC_PER_USEC)
+#define LATENCY (1000 * WR_NSEC_PER_USEC)
+
+
+/**
+ * Send packets through the link with the given inter-arrival time and check the received stream:
+ * order of packets is kept, frames do not overlap on the link and every delay is in [min_delay, max_delay]
+ * (the first warmup packets, which arrive before the queue fills, are delayed by serialization and latency at least)
+ * @param lost number of dropped packets
+ * @param mean_delay mean delay of the received packets after the warmup
+ */
+static int check_link(wr_rtp_filter_t * link, wr_rtp_filter_t * sink, wr_rtp_packet_t * packets, wr_time_t interval,
+        int batch_size, int warmup, wr_time_t min_delay, wr_time_t max_delay, int * lost, double * mean_delay)
+{
+    wr_errorcode_t err;
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    double sum_delay = 0;
+    int steady = 0;
+    size_t i;
+    for (i = 0; i < PACKETS; i++)
+        packets[i].lowlevel_timestamp = i * interval;
+    CHECK( wr_test_transmit(link, packets, PACKETS, batch_size) );
+    ASSERT(state->finished, "transmission is not finished");
+    for (i = 0; i < state->count; i++){
+        wr_test_record_t * cur = &state->records[i];
+        wr_time_t delay = cur->lowlevel_timestamp - cur->sequence_number * interval;
+        if (i > 0){
+            wr_test_record_t * prev = &state->records[i - 1];
+            ASSERT(prev->sequence_number < cur->sequence_number, "packets %d and %d are swapped", prev->sequence_number, cur->sequence_number);
+            ASSERT(cur->lowlevel_timestamp - prev->lowlevel_timestamp >= SERVICE_TIME,
+                    "packets %d and %d overlap on the link", prev->sequence_number, cur->sequence_number);
+        }
+        ASSERT(delay <= max_delay, "packet %d is delayed by %lld ns, more than %lld ns",
+                cur->sequence_number, (long long)delay, (long long)max_delay);
+        if (cur->sequence_number < warmup){
+            ASSERT(delay >= SERVICE_TIME + LATENCY, "packet %d is delayed by %lld ns only", cur->sequence_number, (long long)delay);
+            continue;
+        }
+        ASSERT(delay >= min_delay, "packet %d is delayed by %lld ns, less than %lld ns",
+                cur->sequence_number, (long long)delay, (long long)min_delay);
+        sum_delay += delay;
+        steady++;
+    }
+    *lost = PACKETS - state->count;
+    *mean_delay = steady ? sum_delay / steady : 0;
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t link, sink;
+    static wr_rtp_packet_t packets[PACKETS];
+    int batch_sizes[] = {1, WR_MAX_BATCH_SIZE};
+    int lost;
+    double mean_delay;
+    size_t i, b;
+
+    CHECK( wr_test_options_init("link_test") );
+    CHECK( wr_test_set_option("link:enabled=true") );
+    CHECK( wr_test_set_option("link:report=false") );
+    CHECK( wr_test_set_option("link:rate=1000000") );
+    CHECK( wr_test_set_option("link:latency=1000") );
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&link, "link", &wr_link_filter_notify, &wr_link_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++){
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, 0) );
+        packets[i].payload_size = FRAME_SIZE - WR_PCAP_LINK_HEADERS_SIZE - sizeof(wr_rtp_header_t);
+        ASSERT(wr_pcap_frame_size(&packets[i]) == FRAME_SIZE, "wrong frame size");
+    }
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* input below the rate: nothing is queued, each packet is delayed by serialization and propagation */
+        CHECK( wr_test_set_option("link:queue_size=1000") );
+        CHECK( check_link(&link, &sink, packets, 2 * SERVICE_TIME, batch_sizes[b],
+                    0, SERVICE_TIME + LATENCY, SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(lost == 0, "%d packets are lost below the rate", lost);
+
+        /* input at twice the rate into the queue of 10 frames: the queue is full after 20 packets,
+         * then half of the packets are dropped at the tail and the rest wait for 9 to 10 frames */
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME / 2, batch_sizes[b],
+                    20, 9 * SERVICE_TIME + LATENCY, 10 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        /* the link sends PACKETS / 2 frames while packets arrive, the full queue is sent after them */
+        ASSERT(abs(lost - (PACKETS / 2 - 10)) <= 1, "%d packets are dropped instead of %d", lost, PACKETS / 2 - 10);
+        ASSERT(mean_delay > 9.4 * SERVICE_TIME + LATENCY && mean_delay <= 10 * SERVICE_TIME + LATENCY,
+                "mean queueing delay is %.0f ns", mean_delay - SERVICE_TIME - LATENCY);
+
+        /* the same with the limit of 4 packets in the large queue */
+        CHECK( wr_test_set_option("link:queue_size=1000000") );
+        CHECK( wr_test_set_option("link:queue_packets=4") );
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME / 2, batch_sizes[b],
+                    8, 3 * SERVICE_TIME + LATENCY, 4 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(abs(lost - (PACKETS / 2 - 4)) <= 1, "%d packets are dropped instead of %d", lost, PACKETS / 2 - 4);
+
+        /* input at three times the rate into the queue of 400 frames: the queue grows beyond its initial
+         * capacity when its head is in the middle of the ring, and overflows after 600 packets */
+        CHECK( wr_test_set_option("link:queue_packets=0") );
+        CHECK( wr_test_set_option("link:queue_size=40000") );
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME / 3, batch_sizes[b],
+                    600, 399 * SERVICE_TIME + LATENCY, 400 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(abs(lost - (PACKETS - PACKETS / 3 - 400)) <= 1, "%d packets are dropped instead of %d", lost, PACKETS - PACKETS / 3 - 400);
+
+        /* the queue which does not overflow: packet i waits for i / 2 frames */
+        CHECK( wr_test_set_option("link:queue_size=1000000") );
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME / 2, batch_sizes[b],
+                    0, SERVICE_TIME + LATENCY, (PACKETS + 2) / 2 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(lost == 0, "%d packets are lost in the large queue", lost);
+        for (i = 0; i < PACKETS; i++)
+            ASSERT(wr_test_sink_state(&sink)->records[i].lowlevel_timestamp == (i + 1) * SERVICE_TIME + LATENCY,
+                    "packet %u is sent at %lld ns", (unsigned)i, (long long)wr_test_sink_state(&sink)->records[i].lowlevel_timestamp);
+
+        /* token bucket of 10 frames with the line rate of 10 Mbit/s and input at twice the token rate:
+         * the full bucket sends frames in 80 us until it is empty, then frames leave with the token rate.
+         * Cross traffic of 0.5 Mbit/s halves the token rate and slows down the line rate to 9.5 Mbit/s. */
+        CHECK( wr_test_set_option("link:burst=1000") );
+        CHECK( wr_test_set_option("link:line_rate=10000000") );
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = i * SERVICE_TIME / 2;
+        {
+            char * cross_traffic[] = {"link:cross_traffic=0", "link:cross_traffic=500000"};
+            wr_time_t serialization[] = {SERVICE_TIME / 10, (wr_time_t)(FRAME_SIZE * 8 * 1e9 / 9500000 + 0.5)};
+            wr_time_t token_gap[] = {SERVICE_TIME, 2 * SERVICE_TIME};
+            size_t k;
+            for (k = 0; k < sizeof(cross_traffic) / sizeof(cross_traffic[0]); k++){
+                wr_test_sink_state_t * state = wr_test_sink_state(&sink);
+                CHECK( wr_test_set_option(cross_traffic[k]) );
+                CHECK( wr_test_transmit(&link, packets, PACKETS, batch_sizes[b]) );
+                ASSERT(state->count == PACKETS, "%u packets are received from the token bucket", (unsigned)state->count);
+                for (i = 0; i < 10; i++)
+                    ASSERT(state->records[i].lowlevel_timestamp == packets[i].lowlevel_timestamp + serialization[k] + LATENCY,
+                            "%s: packet %u is delayed by %lld ns in the full bucket", cross_traffic[k], (unsigned)i,
+                            (long long)(state->records[i].lowlevel_timestamp - packets[i].lowlevel_timestamp));
+                for (i = 40; i < PACKETS; i++){
+                    wr_time_t gap = state->records[i].lowlevel_timestamp - state->records[i - 1].lowlevel_timestamp;
+                    ASSERT(gap >= token_gap[k] - 1 && gap <= token_gap[k] + 1, "%s: packet %u is sent %lld ns after the previous one",
+                            cross_traffic[k], (unsigned)i, (long long)gap);
+                }
+            }
+        }
+        CHECK( wr_test_set_option("link:burst=0") );
+        CHECK( wr_test_set_option("link:line_rate=0") );
+
+        /* cross traffic takes half of the rate: each frame is sent in 1600 us,
+         * input at twice the rest of the rate overflows the queue of 10 frames */
+        CHECK( wr_test_set_option("link:cross_traffic=500000") );
+        CHECK( wr_test_set_option("link:queue_size=1000") );
+        CHECK( check_link(&link, &sink, packets, 4 * SERVICE_TIME, batch_sizes[b],
+                    0, 2 * SERVICE_TIME + LATENCY, 2 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(lost == 0, "%d packets are lost below the rest of the rate", lost);
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME, batch_sizes[b],
+                    20, 18 * SERVICE_TIME + LATENCY, 20 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(abs(lost - (PACKETS / 2 - 10)) <= 1, "%d packets are dropped instead of %d with cross traffic", lost, PACKETS / 2 - 10);
+        CHECK( wr_test_set_option("link:cross_traffic=0") );
+
+        /* RED in the queue which is never full: packets are dropped early, so the queue stays near red_max */
+        CHECK( wr_test_set_option("link:queue_size=100000") );
+        CHECK( wr_test_set_option("link:aqm=red") );
+        CHECK( wr_test_set_option("link:red_min=2000") );
+        CHECK( wr_test_set_option("link:red_max=6000") );
+        CHECK( wr_test_set_option("link:red_probability=0.1") );
+        CHECK( wr_test_set_option("link:red_weight=0.05") );
+        CHECK( check_link(&link, &sink, packets, SERVICE_TIME / 2, batch_sizes[b],
+                    0, SERVICE_TIME + LATENCY, 90 * SERVICE_TIME + LATENCY, &lost, &mean_delay) );
+        ASSERT(lost > PACKETS / 3, "only %d packets are dropped by RED", lost);
+        ASSERT(mean_delay > 20 * SERVICE_TIME + LATENCY && mean_delay < 70 * SERVICE_TIME + LATENCY,
+                "mean queueing delay with RED is %.0f ns", mean_delay - SERVICE_TIME - LATENCY);
+        CHECK( wr_test_set_option("link:aqm=taildrop") );
+    }
+
+    /* the filter takes one stream with and without RED and with invalid options,
+     * so streams of the following filters do not depend on them */
+    {
+        char * options[] = {"link:aqm=red", "link:aqm=taildrop", "link:cross_traffic=2000000", "link:enabled=false"};
+        wr_prng_t stream, expected_stream, expected_copy;
+        size_t k;
+        wr_prng_stream_init(&expected_stream);
+        for (k = 0; k < sizeof(options) / sizeof(options[0]); k++){
+            CHECK( wr_test_set_option(options[k]) );
+            wr_test_transmit(&link, packets, 1, 1);
+            wr_prng_stream_init(&stream);
+            wr_prng_jump(&expected_stream);
+            wr_prng_jump(&expected_stream);
+            expected_copy = expected_stream;
+            ASSERT(wr_prng_next(&stream) == wr_prng_next(&expected_copy), "stream of the filter is not taken with %s", options[k]);
+        }
+    }
+
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
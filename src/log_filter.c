@@ -37,6 +37,36 @@
 #include "log_filter.h"
 
 
+static void __log_packet(wr_log_filter_state_t * state, wr_rtp_packet_t * packet)
+{
+    char diff[256];
+    memset(diff, 0, sizeof(diff));
+    /* count diff between current and previous timestamps */
+    if (!state->prev_timestamp){
+        strncpy(diff, "--.------", 255);
+    } else {
+        char diffsign = '+';
+        wr_time_t timediff = packet->lowlevel_timestamp - state->prev_timestamp;
+        if (timediff < 0){
+            timediff = -timediff;
+            diffsign = '-';
+        }
+        snprintf(diff, 256, "%c%ld.%06ld", diffsign, (long)(timediff / WR_NSEC_PER_SEC), (long)(timediff % WR_NSEC_PER_SEC / WR_NSEC_PER_USEC));
+    }
+    
+    printf("%ld.%06ld\t%s\t%d\t%d\t%d\n", 
+        (long)(packet->lowlevel_timestamp / WR_NSEC_PER_SEC), 
+        (long)(packet->lowlevel_timestamp % WR_NSEC_PER_SEC / WR_NSEC_PER_USEC), 
+        diff, 
+        packet->sequence_number,
+        packet->rtp_timestamp, 
+        packet->payload_type
+    );
+    state->prev_timestamp = packet->lowlevel_timestamp;
+}
+
+
+
 wr_errorcode_t wr_log_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
 {
     switch(event){
@@ -49,38 +79,12 @@ wr_errorcode_t wr_log_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t ev
             return WR_OK;
         }
         case NEW_PACKET: {
-            char diff[256];
             wr_log_filter_state_t * state = (wr_log_filter_state_t * ) (filter->state);
             if (!state->enabled){
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            memset(diff, 0, sizeof(diff));
-            /* count diff between current and previous timestamps */
-            if (!timerisset(&state->prev_timestamp)){
-                strncpy(diff, "--.------", 255);
-            } else {
-                char diffsign;
-                struct timeval timediff;
-                if (timercmp(&packet->lowlevel_timestamp, &state->prev_timestamp, >=)){
-                    timersub(&packet->lowlevel_timestamp, &state->prev_timestamp, &timediff);
-                    diffsign = '+';
-                } else {
-                    timersub(&state->prev_timestamp, &packet->lowlevel_timestamp, &timediff);
-                    diffsign = '-';
-                }
-                snprintf(diff, 256, "%c%ld.%06ld", diffsign, timediff.tv_sec, (long)timediff.tv_usec);
-            }
-            
-            printf("%ld.%06ld\t%s\t%d\t%d\t%d\n", 
-                packet->lowlevel_timestamp.tv_sec, 
-                (long)packet->lowlevel_timestamp.tv_usec, 
-                diff, 
-                packet->sequence_number,
-                packet->rtp_timestamp, 
-                packet->payload_type
-            );
-            memcpy(&state->prev_timestamp, &packet->lowlevel_timestamp, sizeof(struct timeval));
+            __log_packet(state, packet);
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
@@ -91,3 +95,17 @@ wr_errorcode_t wr_log_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t ev
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_log_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_log_filter_state_t * state = (wr_log_filter_state_t * ) (filter->state);
+    int i;
+    if (state->enabled){
+        for (i=0; i<count; i++)
+            __log_packet(state, packets[i]);
+    }
+    wr_rtp_filter_notify_observers_batch(filter, packets, count);
+    return WR_OK;
+}
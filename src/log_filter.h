@@ -46,7 +46,7 @@
  */
 typedef struct __wr_log_filter_state {
     int enabled;
-    struct timeval prev_timestamp;
+    wr_time_t prev_timestamp;
 } wr_log_filter_state_t;
 
 /**
@@ -54,6 +54,11 @@ typedef struct __wr_log_filter_state {
  * This method is invoked when filter is notified.
  */
 wr_errorcode_t wr_log_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_log_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_log_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
 /** @} */
 
 #endif
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <math.h>
+#include "independent_losses_filter.h"
+#include "markov_losses_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 400000
+
+
+/**
+ * Check the loss rate and the mean length of bursts of lost packets measured by the sink
+ */
+static int check_losses(wr_rtp_filter_t * sink, double loss_rate, double burst_length)
+{
+    double measured_rate, measured_burst;
+    wr_test_sink_losses(sink, PACKETS, &measured_rate, &measured_burst);
+    ASSERT(fabs(measured_rate - loss_rate) < 0.05 * loss_rate, "loss rate is %f instead of %f", measured_rate, loss_rate);
+    ASSERT(fabs(measured_burst - burst_length) < 0.05 * burst_length, "mean burst length is %f instead of %f", measured_burst, burst_length);
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t independent, markov, sink;
+    int batch_sizes[] = {1, WR_MAX_BATCH_SIZE};
+    size_t b;
+
+    CHECK( wr_test_options_init("losses_test") );
+    CHECK( wr_test_set_option("independent_losses:enabled=true") );
+    CHECK( wr_test_set_option("independent_losses:loss_rate=0.05") );
+    CHECK( wr_test_set_option("markov_losses:enabled=true") );
+    CHECK( wr_test_set_option("markov_losses:loss_0_1=0.02") );
+    CHECK( wr_test_set_option("markov_losses:loss_1_1=0.6") );
+    wr_prng_seed(1);
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&independent, "independent_losses", &wr_independent_losses_filter_notify, &wr_independent_losses_filter_notify_batch, &sink);
+    wr_test_filter_create(&markov, "markov_losses", &wr_markov_losses_filter_notify, &wr_markov_losses_filter_notify_batch, &sink);
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* losses are independent: bursts are geometric with mean 1 / (1 - p) */
+        CHECK( wr_test_transmit_sequence(&independent, PACKETS, batch_sizes[b]) );
+        if (check_losses(&sink, 0.05, 1 / 0.95))
+            return 1;
+        /* stationary loss rate is p01 / (p01 + 1 - p11), mean burst length is 1 / (1 - p11) */
+        CHECK( wr_test_transmit_sequence(&markov, PACKETS, batch_sizes[b]) );
+        if (check_losses(&sink, 0.02 / (0.02 + 0.4), 1 / 0.4))
+            return 1;
+    }
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -33,9 +33,37 @@
  *
  */
 #include <sys/time.h>
+#include <string.h>
 #include "markov_losses_filter.h"
 
 
+
+/**
+ * Draw number of packets which follow in the current state:
+ * received packets before the next loss or lost packets before the next received one
+ */
+static void __draw_run(wr_markov_losses_filter_state_t * state)
+{
+    state->run = wr_prng_geometric(&state->prng, state->prev_lost ? 1 - state->loss_1_1 : state->loss_0_1);
+}
+
+
+
+/**
+ * Decide whether the next packet is lost
+ */
+static int __next_lost(wr_markov_losses_filter_state_t * state)
+{
+    if (state->run){
+        state->run--;
+    } else {
+        state->prev_lost = !state->prev_lost;
+        __draw_run(state);
+    }
+    return state->prev_lost;
+}
+
+
 wr_errorcode_t wr_markov_losses_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
 {
     switch(event){
@@ -52,22 +80,20 @@ wr_errorcode_t wr_markov_losses_filter_notify(wr_rtp_filter_t * filter, wr_event
             if (state->loss_0_1 < 0 )  state->loss_0_1 = 0;
             if (state->loss_0_1 > 1 )  state->loss_0_1 = 1; 
 
+            wr_prng_stream_init(&state->prng);
+            __draw_run(state);
+
             filter->state = (void*)state;
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
         case NEW_PACKET: {
-            double rand_val;
             wr_markov_losses_filter_state_t * state = (wr_markov_losses_filter_state_t * ) (filter->state);
             if (!state->enabled){
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            double threshold =  (state->prev_lost) ? state->loss_1_1 : state->loss_0_1;
-            int lost;
-            rand_val = (double) rand() / RAND_MAX;
-            state->prev_lost = (rand_val < threshold) ? 1 : 0;
-            if (!state->prev_lost){
+            if (!__next_lost(state)){
                 wr_rtp_filter_notify_observers(filter, event, packet);
             }
             return WR_OK;
@@ -80,3 +106,41 @@ wr_errorcode_t wr_markov_losses_filter_notify(wr_rtp_filter_t * filter, wr_event
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_markov_losses_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_markov_losses_filter_state_t * state = (wr_markov_losses_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t * passed[count];
+    int i = 0, passed_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    if (!state->prev_lost && state->run >= (uint64_t)count){
+        /* no losses in this batch */
+        state->run -= count;
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    while (i < count){
+        /* packets of the current run, then the packet which changes the state */
+        int run = count - i;
+        if (state->run < (uint64_t)run)
+            run = (int)state->run;
+        if (!state->prev_lost){
+            memcpy(&passed[passed_count], &packets[i], run * sizeof(*passed));
+            passed_count += run;
+        }
+        state->run -= run;
+        i += run;
+        if (i < count){
+            if (!__next_lost(state))
+                passed[passed_count++] = packets[i];
+            i++;
+        }
+    }
+    wr_rtp_filter_notify_observers_batch(filter, passed, passed_count);
+    return WR_OK;
+}
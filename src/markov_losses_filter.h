@@ -35,6 +35,7 @@
 #ifndef MARKOV_LOSSES_FILTER_H
 #define MARKOV_LOSSES_FILTER_H
 #include "rtpapi.h"
+#include "prng.h"
 
 /** @defgroup markov_losses markov losses filter
  * This filter emulates markov random losses.
@@ -44,6 +45,9 @@
  * loss_0_1 = float from 0 to 1, loss probability on conditions that prevoius packet was NOT lost
  * loss_1_1 = float from 0 to 1, loss probability on conditions that prevoius packet was lost
  *
+ * The filter does not draw a random number per packet: when the state changes, the number of
+ * packets which stay in the new state is drawn from the geometric distribution.
+ *
  *  @{
  */
 
@@ -56,6 +60,8 @@ typedef struct __wr_markov_losses_filter_state {
     int  prev_lost;
     double loss_0_1;
     double loss_1_1;
+    uint64_t run;                       /**< number of packets before the next change of the state */
+    wr_prng_t prng;
 } wr_markov_losses_filter_state_t;
 
 /**
@@ -63,6 +69,11 @@ typedef struct __wr_markov_losses_filter_state {
  * This method is invoked when filter is notified.
  */
 wr_errorcode_t wr_markov_losses_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_markov_losses_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_markov_losses_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
 /** @} */
 
 #endif
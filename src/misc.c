@@ -37,6 +37,7 @@
 
 #include <stdio.h>
 #include <sys/time.h>
+#include <time.h>
 #include "misc.h"
 
 
@@ -61,19 +62,26 @@ void wr_dump(void * data, int size)
 
 
 
-void timeval_increment(struct timeval * tv, int ms)
+wr_time_t wr_time_now(void)
 {
-    tv->tv_usec += (ms % 1000000);    
-    tv->tv_sec += (ms / 1000000);
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (wr_time_t)tv.tv_sec * WR_NSEC_PER_SEC + (wr_time_t)tv.tv_usec * WR_NSEC_PER_USEC;
+}
+
 
-    tv->tv_sec += tv->tv_usec / 1000000;
-    tv->tv_usec = tv->tv_usec % 1000000;
+
+void wr_time_to_timeval(wr_time_t time, struct timeval * tv)
+{
+    tv->tv_sec = time / WR_NSEC_PER_SEC;
+    tv->tv_usec = (time % WR_NSEC_PER_SEC) / WR_NSEC_PER_USEC;
 }
 
 
 
-void timeval_copy(struct timeval * dst, const struct timeval * src)
+uint64_t wr_clock_ns(void)
 {
-    dst->tv_sec = src->tv_sec;
-    dst->tv_usec = src->tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
@@ -36,6 +36,7 @@
 #define __WR_MISC_H
 
 #include <sys/time.h>
+#include <stdint.h>
 
 /** @defgroup misc miscellaneous
  *  Miscellaneous helper functions 
@@ -49,19 +50,30 @@
 void wr_dump(void * data, int size);
 
 /**
- * Increment given timeval to given number of microseconds (usec)
+ * Time in nanoseconds. Timestamps of the packets are counted from the Epoch,
+ * they are converted to struct timeval only by output filters.
  */
-void timeval_increment(struct timeval * tv, int us);
+typedef int64_t wr_time_t;
 
+#define WR_NSEC_PER_USEC 1000LL
+#define WR_NSEC_PER_MSEC 1000000LL
+#define WR_NSEC_PER_SEC  1000000000LL
 
 /**
- * Copy values of the time from src to dst
+ * Return current (wall clock) time
  */
-void timeval_copy(struct timeval * dst, const struct timeval * src);
+wr_time_t wr_time_now(void);
 
-#ifdef _WIN32
-void timersub(const struct timeval *a, const struct timeval *b, struct timeval *res);
-#endif
+/**
+ * Convert the time to struct timeval (nanoseconds are truncated to microseconds)
+ */
+void wr_time_to_timeval(wr_time_t time, struct timeval * tv);
+
+
+/**
+ * Return value of the monotonic clock in nanoseconds (used to measure time intervals)
+ */
+uint64_t wr_clock_ns(void);
 
 #endif
 
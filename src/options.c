@@ -59,7 +59,7 @@ static void print_usage(const char * confdir)
             "  -v, --version            \tPrint to stdout version of this tool\n"
             "  -f, --from-file          \tFilename from which sound (speech) data will be readed\n"
             "  -t, --to-file            \tOutput file\n"
-            "  -m, --format             \tOutput Format (pcap or rtpdump)\n"
+            "  -m, --format             \tOutput Format (pcap, pcapng or rtpdump)\n"
             "  -c, --codec-list         \tComma separated list of codecs (without spaces), which will be used to encode .wav file\n"
             "  -o, --output-option      \tOutput option which redefine %s/output.conf. Recorded in form \"section:key=value\"\n"
             "  -O, --codecs-option       \tCodec option which redefine %s/codecs.conf. Recorded in the form \"section:key=value\"\n"
@@ -78,6 +78,10 @@ static void print_usage(const char * confdir)
             "  wav2rtp -f test.wav -t test.dump -c PCMA -m rtpdump\n"
             "\n"
             "This reads file \"test.wav\", encodes it with G.711 and stores data in rtpdump file \"test.dump\"\n"
+            "\n"
+            "  wav2rtp -f test.wav -t test.pcap -c PCMU -o global:pipeline=independent_losses,sort -o global:sinks=pcap,rtpdump -o rtpdump:filename=test.dump\n"
+            "\n"
+            "This passes packets through the losses filter then through the sort filter and stores them both in pcap and rtpdump files\n"
             "\n",
             confdir, confdir, confdir
     );
@@ -94,6 +98,8 @@ static wr_output_format __output_format_arg(const char *format)
         return WR_OUTPUT_PCAP;
     if (!strcasecmp(format, "rtpdump"))
         return WR_OUTPUT_RTPDUMP;
+    if (!strcasecmp(format, "pcapng"))
+        return WR_OUTPUT_PCAPNG;
     return WR_OUTPUT_UNKNOWN;
 }
 
@@ -230,7 +236,7 @@ wr_errorcode_t get_options(const int argc, char * const argv[],
         return WR_FATAL;
     }
     if (wr_options.output_format == WR_OUTPUT_UNKNOWN){
-        wr_set_error("output format is unsupported. Supported formats are pcap and rtpdump");
+        wr_set_error("output format is unsupported. Supported formats are pcap, pcapng and rtpdump");
         return WR_FATAL;
     }
     return WR_OK;
@@ -0,0 +1,298 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _GNU_SOURCE
+/* sync_file_range and O_DIRECT */
+#define _GNU_SOURCE
+#endif
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include "wincompat.h"
+#else
+#include <sys/uio.h>
+#endif
+#include "output_writer.h"
+#include "options.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+
+
+/**
+ * Write all data given with iov, continue after partial writes
+ */
+static wr_errorcode_t __write_all(int fd, struct iovec * iov, int iovcnt)
+{
+    while (iovcnt > 0){
+#ifdef _WIN32
+        ssize_t written = write(fd, iov->iov_base, iov->iov_len);
+#else
+        ssize_t written = writev(fd, iov, iovcnt);
+#endif
+        if (written < 0){
+            if (errno == EINTR)
+                continue;
+            wr_set_error("cannot write to the output file");
+            return WR_FATAL;
+        }
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len){
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0){
+            iov->iov_base = (uint8_t *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Tell the kernel that pages written before offset will not be read.
+ * Dirty pages are not dropped, so the range of the previous writes is advised only when its
+ * writeback is done (on Linux writeback of the new range is started and the previous one is waited for).
+ */
+static void __drop_written(wr_output_writer_t * writer, off_t offset)
+{
+#ifdef HAVE_POSIX_FADVISE
+    if (!writer->fadvise)
+        return;
+#ifdef HAVE_SYNC_FILE_RANGE
+    if (writer->offset > offset)
+        sync_file_range(writer->fd, offset, writer->offset - offset, SYNC_FILE_RANGE_WRITE);
+    if (offset > writer->advised)
+        sync_file_range(writer->fd, writer->advised, offset - writer->advised,
+                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+#endif
+    if (offset > writer->advised)
+        posix_fadvise(writer->fd, writer->advised, offset - writer->advised, POSIX_FADV_DONTNEED);
+    writer->advised = offset;
+#endif
+}
+
+
+
+/**
+ * Write given vectors and tell the kernel that previously written pages will not be read
+ */
+static wr_errorcode_t __write_out(wr_output_writer_t * writer, struct iovec * iov, int iovcnt)
+{
+    wr_errorcode_t retval;
+    off_t offset = writer->offset;
+    int i;
+    for (i = 0; i < iovcnt; i++)
+        writer->offset += iov[i].iov_len;
+    if ((retval = __write_all(writer->fd, iov, iovcnt)) != WR_OK)
+        return retval;
+    __drop_written(writer, offset);
+    return WR_OK;
+}
+
+
+
+static wr_errorcode_t __flush(wr_output_writer_t * writer)
+{
+    struct iovec iov;
+    wr_errorcode_t retval;
+    if (writer->used == 0)
+        return WR_OK;
+    iov.iov_base = writer->buffer;
+    iov.iov_len = writer->used;
+    retval = __write_out(writer, &iov, 1);
+    writer->used = 0;
+    return retval;
+}
+
+
+
+wr_errorcode_t wr_output_writer_open(wr_output_writer_t * writer, const char * filename)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_BINARY;
+    int size = iniparser_getnonnegativeint(wr_options.output_options, "global:output_buffer_size", WR_OUTPUT_BUFFER_SIZE);
+
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+    writer->fadvise = iniparser_getboolean(wr_options.output_options, "global:output_fadvise", 1);
+#ifdef O_DIRECT
+    if (iniparser_getboolean(wr_options.output_options, "global:output_direct", 0)){
+        /* some file systems do not support direct io, the file is written through the page cache then */
+        writer->fd = open(filename, flags | O_DIRECT, 0644);
+        writer->direct = (writer->fd >= 0);
+    }
+#endif
+    if (writer->fd < 0)
+        writer->fd = open(filename, flags, 0644);
+    if (writer->fd < 0){
+        wr_set_error("Cannot open output file");
+        return WR_FATAL;
+    }
+
+    if (size < WR_OUTPUT_BUFFER_MIN_SIZE)
+        size = WR_OUTPUT_BUFFER_MIN_SIZE;
+    writer->size = (size_t)size;
+    if (writer->direct){
+        void * buffer = NULL;
+        writer->size -= writer->size % WR_OUTPUT_DIRECT_ALIGNMENT;
+        if (posix_memalign(&buffer, WR_OUTPUT_DIRECT_ALIGNMENT, writer->size) == 0)
+            writer->buffer = buffer;
+    } else {
+        writer->buffer = malloc(writer->size);
+    }
+    if (!writer->buffer){
+        close(writer->fd);
+        writer->fd = -1;
+        wr_set_error("Cannot allocate output buffer");
+        return WR_FATAL;
+    }
+#ifdef HAVE_POSIX_FADVISE
+    if (writer->fadvise)
+        posix_fadvise(writer->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_output_writer_write(wr_output_writer_t * writer, const void * data, size_t size)
+{
+    const uint8_t * ptr = data;
+    wr_errorcode_t retval;
+
+    if (writer->used + size < writer->size){
+        memcpy(writer->buffer + writer->used, ptr, size);
+        writer->used += size;
+        return WR_OK;
+    }
+    if (!writer->direct){
+        /* buffer and the record are written with one call */
+        struct iovec iov[2];
+        iov[0].iov_base = writer->buffer;
+        iov[0].iov_len = writer->used;
+        iov[1].iov_base = (void *)ptr;
+        iov[1].iov_len = size;
+        writer->used = 0;
+        return __write_out(writer, iov, 2);
+    }
+    /* direct io: only whole aligned buffers are written */
+    while (writer->used + size >= writer->size){
+        size_t chunk = writer->size - writer->used;
+        memcpy(writer->buffer + writer->used, ptr, chunk);
+        writer->used = writer->size;
+        ptr += chunk;
+        size -= chunk;
+        if ((retval = __flush(writer)) != WR_OK)
+            return retval;
+    }
+    memcpy(writer->buffer, ptr, size);
+    writer->used = size;
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_output_writer_reserve(wr_output_writer_t * writer, size_t size, uint8_t ** record)
+{
+    wr_errorcode_t retval;
+    if (writer->used + size > writer->size){
+        if (writer->direct){
+            /* direct io: aligned part of the buffer is written, the rest is moved to its beginning */
+            struct iovec iov;
+            size_t tail = writer->used % WR_OUTPUT_DIRECT_ALIGNMENT;
+            iov.iov_base = writer->buffer;
+            iov.iov_len = writer->used - tail;
+            if (iov.iov_len && (retval = __write_out(writer, &iov, 1)) != WR_OK)
+                return retval;
+            memmove(writer->buffer, writer->buffer + writer->used - tail, tail);
+            writer->used = tail;
+        } else if ((retval = __flush(writer)) != WR_OK){
+            return retval;
+        }
+        if (writer->used + size > writer->size){
+            wr_set_error("record is larger than the output buffer");
+            return WR_FATAL;
+        }
+    }
+    *record = writer->buffer + writer->used;
+    return WR_OK;
+}
+
+
+
+void wr_output_writer_commit(wr_output_writer_t * writer, size_t size)
+{
+    writer->used += size;
+}
+
+
+
+wr_errorcode_t wr_output_writer_close(wr_output_writer_t * writer)
+{
+    wr_errorcode_t retval = WR_OK;
+    if (writer->fd < 0)
+        return WR_OK;
+#if defined(O_DIRECT) && defined(F_SETFL)
+    if (writer->direct){
+        /* the tail of the file is not aligned, it is written through the page cache */
+        fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL) & ~O_DIRECT);
+        writer->direct = 0;
+    }
+#endif
+    retval = __flush(writer);
+#ifdef HAVE_SYNC_FILE_RANGE
+    /* the last range is written back as well, without it the advice does nothing */
+    __drop_written(writer, writer->offset);
+#endif
+    if (close(writer->fd) != 0 && retval == WR_OK){
+        wr_set_error("cannot close output file");
+        retval = WR_FATAL;
+    }
+    writer->fd = -1;
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return retval;
+}
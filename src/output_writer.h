@@ -0,0 +1,102 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "error_types.h"
+
+/** @defgroup output_writer buffered output writer
+ * Output filters which produce files (pcap, rtpdump) put whole records into a large buffer,
+ * which is written to the file with one system call when it is full.
+ * Size of the buffer is given with "global:output_buffer_size" option.
+ * With "global:output_direct" the file is opened with O_DIRECT (where available) and the page
+ * cache is bypassed, with "global:output_fadvise" the kernel is told that the file is written
+ * sequentially and pages of the previous writes are not needed anymore (on Linux their writeback
+ * is forced with sync_file_range, dirty pages cannot be dropped).
+ *  @{
+ */
+
+/** Default size of the output buffer (4 MB) */
+#define WR_OUTPUT_BUFFER_SIZE (4 * 1024 * 1024)
+
+/** Minimum size of the output buffer, any record has to fit into it */
+#define WR_OUTPUT_BUFFER_MIN_SIZE (64 * 1024)
+
+/** Alignment of the buffer and of the writes in the O_DIRECT mode */
+#define WR_OUTPUT_DIRECT_ALIGNMENT 4096
+
+/** Buffered output file */
+typedef struct __wr_output_writer {
+    int fd;                 /**< file descriptor */
+    uint8_t * buffer;       /**< buffer which collects records */
+    size_t size;            /**< size of the buffer */
+    size_t used;            /**< number of bytes in the buffer */
+    off_t offset;           /**< number of bytes written to the file */
+    off_t advised;          /**< pages before this offset are given to POSIX_FADV_DONTNEED */
+    int direct;             /**< file is opened with O_DIRECT */
+    int fadvise;            /**< give hints to the page cache */
+} wr_output_writer_t;
+
+/**
+ * Open (truncate) the file and allocate the buffer according to the output options
+ */
+wr_errorcode_t wr_output_writer_open(wr_output_writer_t * writer, const char * filename);
+
+/**
+ * Append data to the buffer, the buffer is written to the file when it is full
+ */
+wr_errorcode_t wr_output_writer_write(wr_output_writer_t * writer, const void * data, size_t size);
+
+/**
+ * Get space for a record of given size in the buffer, so the record may be built in place
+ * (the buffer is written to the file if the record does not fit into its free space).
+ * Record is appended to the output with #wr_output_writer_commit
+ */
+wr_errorcode_t wr_output_writer_reserve(wr_output_writer_t * writer, size_t size, uint8_t ** record);
+
+/**
+ * Append the record built in the space given by #wr_output_writer_reserve
+ */
+void wr_output_writer_commit(wr_output_writer_t * writer, size_t size);
+
+/**
+ * Write the rest of the buffer, close the file and free the buffer
+ */
+wr_errorcode_t wr_output_writer_close(wr_output_writer_t * writer);
+
+/** @} */
+#endif
@@ -0,0 +1,198 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "packet_pool.h"
+
+
+/** Packet as it is stored in the pool */
+typedef struct __wr_pool_packet {
+    wr_rtp_packet_t packet;             /**< must be the first member */
+    struct __wr_pool_packet * next_free;
+} wr_pool_packet_t;
+
+/** Slab header, WR_PACKET_POOL_SLAB_SIZE packets follow it */
+typedef struct __wr_pool_slab {
+    struct __wr_pool_slab * next;
+} wr_pool_slab_t;
+
+#define __slab_packets(slab) ((wr_pool_packet_t *)((slab) + 1))
+
+
+
+static int __grow(wr_packet_pool_t * pool)
+{
+    int i;
+    wr_pool_slab_t * slab = calloc(1, sizeof(*slab) + WR_PACKET_POOL_SLAB_SIZE * sizeof(wr_pool_packet_t));
+    if (!slab)
+        return 0;
+    pool->stats.heap_allocs++;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    for (i=WR_PACKET_POOL_SLAB_SIZE-1; i>=0; i--){
+        wr_pool_packet_t * p = &__slab_packets(slab)[i];
+        p->packet.pool = pool;
+        p->next_free = pool->free_packets;
+        pool->free_packets = p;
+    }
+    return 1;
+}
+
+
+
+void wr_packet_pool_init(wr_packet_pool_t * pool)
+{
+    memset(pool, 0, sizeof(*pool));
+}
+
+
+
+void wr_packet_pool_destroy(wr_packet_pool_t * pool)
+{
+    wr_pool_slab_t * slab = pool->slabs;
+    wr_rtp_buffer_t * buffer = pool->free_buffers;
+    while (buffer){
+        wr_rtp_buffer_t * next = buffer->next_free;
+        free(buffer);
+        pool->stats.heap_frees++;
+        buffer = next;
+    }
+    while (slab){
+        wr_pool_slab_t * next = slab->next;
+        free(slab);
+        pool->stats.heap_frees++;
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_packets = NULL;
+    pool->free_buffers = NULL;
+    pool->packets_in_use = 0;
+}
+
+
+
+wr_rtp_packet_t * wr_packet_pool_acquire(wr_packet_pool_t * pool, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, wr_time_t lowlevel_timestamp)
+{
+    wr_pool_packet_t * p;
+    if (!pool->free_packets && !__grow(pool))
+        return NULL;
+    p = pool->free_packets;
+    /* headroom is always available, even for the empty packet */
+    p->packet.buffer = wr_packet_pool_get_buffer(pool, 0);
+    if (!p->packet.buffer)
+        return NULL;
+    pool->free_packets = p->next_free;
+    p->next_free = NULL;
+
+    p->packet.payload_type = payload_type;
+    p->packet.sequence_number = sequence_number;
+    p->packet.markbit = markbit;
+    p->packet.rtp_timestamp = rtp_timestamp;
+    p->packet.lowlevel_timestamp = lowlevel_timestamp;
+    p->packet.frames_count = 0;
+    p->packet.payload_size = 0;
+
+    pool->stats.packets_acquired++;
+    pool->packets_in_use++;
+    if (pool->packets_in_use > pool->stats.packets_peak)
+        pool->stats.packets_peak = pool->packets_in_use;
+    return &p->packet;
+}
+
+
+
+void wr_packet_pool_release(wr_packet_pool_t * pool, wr_rtp_packet_t * packet)
+{
+    wr_pool_packet_t * p = (wr_pool_packet_t *)packet;
+    wr_rtp_buffer_unref(packet->buffer);
+    packet->buffer = NULL;
+    p->next_free = pool->free_packets;
+    pool->free_packets = p;
+    pool->stats.packets_released++;
+    pool->packets_in_use--;
+}
+
+
+
+wr_rtp_buffer_t * wr_packet_pool_get_buffer(wr_packet_pool_t * pool, size_t capacity)
+{
+    wr_rtp_buffer_t * buffer = pool->free_buffers;
+    if (buffer){
+        pool->free_buffers = buffer->next_free;
+        if (buffer->capacity < capacity){
+            wr_rtp_buffer_t * grown = realloc(buffer, sizeof(wr_rtp_buffer_t) + WR_RTP_PACKET_HEADROOM + capacity);
+            if (!grown){
+                free(buffer);
+                pool->stats.heap_frees++;
+                return NULL;
+            }
+            pool->stats.heap_allocs++;
+            buffer = grown;
+            buffer->capacity = capacity;
+        }
+    } else {
+        buffer = malloc(sizeof(wr_rtp_buffer_t) + WR_RTP_PACKET_HEADROOM + capacity);
+        if (!buffer)
+            return NULL;
+        pool->stats.heap_allocs++;
+        buffer->capacity = capacity;
+        buffer->pool = pool;
+    }
+    buffer->refcount = 1;
+    buffer->next_free = NULL;
+    pool->stats.buffers_acquired++;
+    return buffer;
+}
+
+
+
+void wr_packet_pool_put_buffer(wr_packet_pool_t * pool, wr_rtp_buffer_t * buffer)
+{
+    buffer->next_free = pool->free_buffers;
+    pool->free_buffers = buffer;
+    pool->stats.buffers_released++;
+}
+
+
+
+void wr_packet_pool_print_stats(wr_packet_pool_t * pool, FILE * stream)
+{
+    fprintf(stream, "packet pool: heap_allocs=%lu heap_frees=%lu "
+            "packets_acquired=%lu packets_released=%lu packets_peak=%lu "
+            "buffers_acquired=%lu buffers_released=%lu\n",
+            pool->stats.heap_allocs, pool->stats.heap_frees,
+            pool->stats.packets_acquired, pool->stats.packets_released, pool->stats.packets_peak,
+            pool->stats.buffers_acquired, pool->stats.buffers_released);
+}
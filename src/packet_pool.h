@@ -0,0 +1,125 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+#include <stdio.h>
+#include "rtpapi.h"
+
+/** @defgroup packet_pool packet pool
+ * Per-transmission slab allocator for RTP packets and their payload buffers.
+ *
+ * Packets are carved from slabs and returned to a free list when they are
+ * released, so once the pool has warmed up the source does not touch the
+ * heap at all. Payload buffers are reference counted: a buffer goes back
+ * to the free list of buffers when the last packet which shares it is
+ * released, and is grown only when a larger payload arrives.
+ *
+ * Packets acquired from the pool have wr_rtp_packet_t#pool set, buffers
+ * have wr_rtp_buffer_t#pool set. All references to the buffers have to be
+ * dropped before the pool is destroyed.
+ *  @{
+ */
+
+/** Number of packets allocated at once */
+#define WR_PACKET_POOL_SLAB_SIZE 64
+
+/**
+ * Allocation counters of the pool
+ */
+typedef struct __wr_packet_pool_stats {
+    unsigned long heap_allocs;          /**< heap allocations made by the pool (slabs and payload buffers) */
+    unsigned long heap_frees;           /**< heap deallocations made by the pool */
+    unsigned long packets_acquired;     /**< packets handed out */
+    unsigned long packets_released;     /**< packets given back */
+    unsigned long packets_peak;         /**< maximum number of packets in use at the same time */
+    unsigned long buffers_acquired;     /**< payload buffers handed out */
+    unsigned long buffers_released;     /**< payload buffers given back */
+} wr_packet_pool_stats_t;
+
+struct __wr_pool_slab;
+struct __wr_pool_packet;
+
+/**
+ * Packet pool
+ */
+typedef struct __wr_packet_pool {
+    struct __wr_pool_slab * slabs;          /**< all slabs owned by the pool */
+    struct __wr_pool_packet * free_packets; /**< list of released packets */
+    wr_rtp_buffer_t * free_buffers;         /**< list of released payload buffers */
+    unsigned long packets_in_use;
+    wr_packet_pool_stats_t stats;
+} wr_packet_pool_t;
+
+/**
+ * Initialize empty pool
+ */
+void wr_packet_pool_init(wr_packet_pool_t * pool);
+
+/**
+ * Free all memory owned by the pool.
+ * Packets which were taken from the pool become invalid, allocation counters are kept.
+ */
+void wr_packet_pool_destroy(wr_packet_pool_t * pool);
+
+/**
+ * Take packet from the pool and initialize it (see #wr_rtp_packet_init)
+ * @return pointer to the packet or NULL if memory cannot be allocated
+ */
+wr_rtp_packet_t * wr_packet_pool_acquire(wr_packet_pool_t * pool, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, wr_time_t lowlevel_timestamp);
+
+/**
+ * Return packet taken with #wr_packet_pool_acquire to the pool
+ * (its payload buffer is returned too unless it is shared with other packets)
+ */
+void wr_packet_pool_release(wr_packet_pool_t * pool, wr_rtp_packet_t * packet);
+
+/**
+ * Take payload buffer which can hold at least capacity bytes, its refcount is set to 1
+ * @return pointer to the buffer or NULL if memory cannot be allocated
+ */
+wr_rtp_buffer_t * wr_packet_pool_get_buffer(wr_packet_pool_t * pool, size_t capacity);
+
+/**
+ * Return payload buffer to the pool (used by #wr_rtp_buffer_unref)
+ */
+void wr_packet_pool_put_buffer(wr_packet_pool_t * pool, wr_rtp_buffer_t * buffer);
+
+/**
+ * Print allocation counters of the pool to the given stream
+ */
+void wr_packet_pool_print_stats(wr_packet_pool_t * pool, FILE * stream);
+
+/** @} */
+#endif
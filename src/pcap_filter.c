@@ -33,6 +33,7 @@
  *
  */
 #include <stdio.h>
+#include <stddef.h>
 #ifdef _WIN32
 #include "wincompat.h"
 #else
@@ -50,7 +51,7 @@
 #endif
 #include <pcap.h>
 
-#include "contrib/in_cksum.h"
+#include "checksum.h"
 #include "pcap_filter.h"
 #include "options.h"
 
@@ -60,7 +61,15 @@
 #endif
 #endif
 
-wr_errorcode_t __init_ether_header(struct ether_header * e)
+/* the record headers must fit into the headroom of the packet */
+typedef char __wr_pcap_headroom_check[(WR_PCAP_RECORD_HEADERS_SIZE <= WR_RTP_PACKET_HEADROOM) ? 1 : -1];
+
+/* offsets of the IP and UDP headers in the link headers template */
+#define WR_PCAP_IP_OFFSET (sizeof(struct ether_header))
+#define WR_PCAP_UDP_OFFSET (sizeof(struct ether_header) + sizeof(struct ip))
+typedef char __wr_pcap_link_headers_check[(WR_PCAP_UDP_OFFSET + sizeof(struct udphdr) == WR_PCAP_LINK_HEADERS_SIZE) ? 1 : -1];
+
+static wr_errorcode_t __init_ether_header(struct ether_header * e)
 {
     struct ether_addr *tmp_addr;
 
@@ -82,7 +91,7 @@ wr_errorcode_t __init_ether_header(struct ether_header * e)
 }
 
 
-wr_errorcode_t __init_ip_header(struct ip * ip_header)
+static wr_errorcode_t __init_ip_header(struct ip * ip_header)
 {
     memset(ip_header, 0, sizeof(*ip_header));
     ip_header->ip_v = 4;
@@ -107,7 +116,7 @@ wr_errorcode_t __init_ip_header(struct ip * ip_header)
 }
 
 
-wr_errorcode_t __init_udp_header(struct udphdr * udp_header)
+static wr_errorcode_t __init_udp_header(struct udphdr * udp_header)
 {
     memset(udp_header, 0, sizeof(*udp_header));
     udp_header->uh_sport = htons((short)iniparser_getnonnegativeint(wr_options.output_options,  "global:src_port", 8001));
@@ -116,6 +125,77 @@ wr_errorcode_t __init_udp_header(struct udphdr * udp_header)
     return WR_OK;
 }
 
+/**
+ * Addresses and ports do not change during transmission, so they are parsed only once;
+ * length fields and checksums are left zero and patched per packet.
+ */
+wr_errorcode_t wr_pcap_link_template_init(wr_pcap_link_template_t * link_template)
+{
+    wr_errorcode_t retval;
+    struct ether_header e_header;
+    struct ip ip_header;
+    struct udphdr udp_header;
+
+    if ((retval=__init_ether_header(&e_header)) != WR_OK){
+        return retval;
+    }
+    if ((retval=__init_ip_header(&ip_header)) != WR_OK){
+        return retval;
+    }
+    if ((retval=__init_udp_header(&udp_header)) != WR_OK){
+        return retval;
+    }
+    memcpy(link_template->headers, &e_header, sizeof(e_header));
+    memcpy(link_template->headers + WR_PCAP_IP_OFFSET, &ip_header, sizeof(ip_header));
+    memcpy(link_template->headers + WR_PCAP_UDP_OFFSET, &udp_header, sizeof(udp_header));
+
+    /* checksums of the template, lengths are added per packet */
+    link_template->ip_sum = wr_cksum_finish(wr_cksum_add(0, &ip_header, sizeof(ip_header)));
+    link_template->udp_checksum = iniparser_getboolean(wr_options.output_options, "global:udp_checksum", 0);
+    {
+        uint8_t protocol[2] = {0, IPPROTO_UDP};
+        uint32_t sum = wr_cksum_add(0, &ip_header.ip_src, sizeof(ip_header.ip_src));
+        sum = wr_cksum_add(sum, &ip_header.ip_dst, sizeof(ip_header.ip_dst));
+        sum = wr_cksum_add(sum, protocol, sizeof(protocol));
+        link_template->udp_sum = wr_cksum_add(sum, &udp_header, sizeof(udp_header));
+    }
+    return WR_OK;
+}
+
+
+
+size_t wr_pcap_link_template_fill(const wr_pcap_link_template_t * link_template, uint8_t * frame, wr_rtp_packet_t * packet)
+{
+    wr_rtp_header_t rtp_header;
+    uint16_t ip_len, udp_len, ip_sum;
+    size_t frame_len;
+
+    wr_rtp_header_init(&rtp_header, packet);
+    udp_len = sizeof(struct udphdr) + sizeof(rtp_header) + packet->payload_size;
+    ip_len = sizeof(struct ip) + udp_len;
+    frame_len = sizeof(struct ether_header) + ip_len;
+
+    /* only lengths and checksums differ from the template */
+    memcpy(frame, link_template->headers, WR_PCAP_LINK_HEADERS_SIZE);
+    memcpy(frame + WR_PCAP_LINK_HEADERS_SIZE, &rtp_header, sizeof(rtp_header));
+    ip_len = htons(ip_len);
+    udp_len = htons(udp_len);
+    memcpy(frame + WR_PCAP_IP_OFFSET + offsetof(struct ip, ip_len), &ip_len, sizeof(ip_len));
+    memcpy(frame + WR_PCAP_UDP_OFFSET + offsetof(struct udphdr, uh_ulen), &udp_len, sizeof(udp_len));
+    ip_sum = wr_cksum_update(link_template->ip_sum, 0, ip_len);
+    memcpy(frame + WR_PCAP_IP_OFFSET + offsetof(struct ip, ip_sum), &ip_sum, sizeof(ip_sum));
+
+    if (link_template->udp_checksum){
+        /* UDP length is counted twice: in the pseudo header and in the UDP header */
+        uint32_t sum = wr_cksum_add(link_template->udp_sum, frame + WR_PCAP_LINK_HEADERS_SIZE, sizeof(rtp_header) + packet->payload_size);
+        uint16_t udp_sum = wr_cksum_finish(sum + 2 * (uint32_t)udp_len);
+        if (udp_sum == 0)
+            udp_sum = 0xffff;
+        memcpy(frame + WR_PCAP_UDP_OFFSET + offsetof(struct udphdr, uh_sum), &udp_sum, sizeof(udp_sum));
+    }
+    return frame_len;
+}
+
 wr_errorcode_t wr_pcap_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
 {
 
@@ -123,14 +203,12 @@ wr_errorcode_t wr_pcap_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
         case TRANSMISSION_START:
             {
                 struct pcap_file_header fh;
-                size_t len;
+                wr_errorcode_t retval;
                 wr_pcap_filter_state_t * state = calloc(1, sizeof(wr_pcap_filter_state_t)); 
-                state->file = fopen(wr_options.output_filename, "wb");
-                if (!state->file){
+                if ((retval = wr_output_writer_open(&state->writer, iniparser_getstring(wr_options.output_options, "pcap:filename", wr_options.output_filename))) != WR_OK){
                     free(state);
                     filter->state = NULL;
-                    wr_set_error("Cannot open output file");
-                    return WR_FATAL;
+                    return retval;
                 }
                 /* Write a header */
                 memset(&fh, 0, sizeof(fh));
@@ -141,13 +219,17 @@ wr_errorcode_t wr_pcap_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
                 fh.sigfigs = 0;
                 fh.snaplen = 0x0000FFFF;
                 fh.linktype = DLT_EN10MB; 
-                len = fwrite(&fh, sizeof(fh), 1, state->file);
-                if (len < 1){
-                    fclose(state->file);
+                if (wr_output_writer_write(&state->writer, &fh, sizeof(fh)) != WR_OK){
+                    wr_output_writer_close(&state->writer);
                     free(state);
                     wr_set_error("Cannot write pcap header to the file");
                     return WR_FATAL;
                 }
+                if ((retval = wr_pcap_link_template_init(&state->link_template)) != WR_OK){
+                    wr_output_writer_close(&state->writer);
+                    free(state);
+                    return retval;
+                }
                 filter->state = (void*)state;
                 return WR_OK;
             }
@@ -155,83 +237,27 @@ wr_errorcode_t wr_pcap_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
 
         case NEW_PACKET:
             {
-                wr_errorcode_t retval;
+                wr_pcap_filter_state_t * state = (wr_pcap_filter_state_t * ) filter->state;
                 struct wr_pcap_pkthdr ph;
-                struct ether_header e_header;
-                struct ip ip_header;
-                struct udphdr udp_header;
-                wr_rtp_header_t rtp_header;
-                vec_t iphdr_vec[] = { /* to count an IP checksum */
-                    {
-                        .ptr = (unsigned char *)&ip_header,
-                        .len = sizeof(ip_header),
-                    },
-                };
-                if ((retval=__init_ether_header(&e_header)) != WR_OK){
-                    return retval;
-                }
-                if ((retval=__init_ip_header(&ip_header)) != WR_OK){
-                    return retval;
-                }
-                if ((retval=__init_udp_header(&udp_header)) != WR_OK){
-                    return retval;
-                }
-                wr_rtp_header_init(&rtp_header, packet);
-
-                ip_header.ip_len = sizeof(ip_header)  + 
-                                   sizeof(udp_header) +                                   
-                                   sizeof(rtp_header);
-                ph.caplen = sizeof(e_header) + ip_header.ip_len;
-                udp_header.uh_ulen = sizeof(udp_header) + sizeof(rtp_header);
-                list_iterator_start(&(packet->data_frames));
-                while(list_iterator_hasnext(&(packet->data_frames))){
-                    wr_data_frame_t * current_data = list_iterator_next(&(packet->data_frames));
-                    ip_header.ip_len += current_data->size;
-                    udp_header.uh_ulen += current_data->size;
-                    ph.caplen += current_data->size;
+                /* headers are put into the headroom of the packet, so the record is written at once */
+                uint8_t * record = wr_rtp_packet_payload(packet) - WR_PCAP_RECORD_HEADERS_SIZE;
+                if (!state){
+                    wr_set_error("internal state of the output filter was not initialized");
+                    return WR_FATAL;
                 }
-                list_iterator_stop(&(packet->data_frames));
-
-                ip_header.ip_len = htons(ip_header.ip_len);
-                udp_header.uh_ulen = htons(udp_header.uh_ulen);
-
-                ip_header.ip_sum = 0;
-                ip_header.ip_sum = in_cksum(iphdr_vec, 1);
-                wr_pcap_timeval_copy(&(ph.ts), &(packet->lowlevel_timestamp));
+                ph.caplen = wr_pcap_link_template_fill(&state->link_template, record + sizeof(ph), packet);
                 ph.len = ph.caplen;
-
-                {
-                    int retval;
-                    wr_pcap_filter_state_t * state = (wr_pcap_filter_state_t * ) filter->state;
-                    if (!filter->state){
-                        wr_set_error("internal state of the output filter was not initialized");
-                        return WR_FATAL;
-                    }
-                    retval = fwrite(&ph, sizeof(ph), 1, state->file);
-                    retval += fwrite(&e_header, sizeof(e_header), 1, state->file);
-                    retval += fwrite(&ip_header, sizeof(ip_header), 1, state->file);
-                    retval += fwrite(&udp_header, sizeof(udp_header), 1, state->file);
-                    retval += fwrite(&rtp_header, sizeof(rtp_header), 1, state->file);
-                    if (retval != 5){
-                        wr_set_error("cannot write packet header");
-                        return WR_FATAL;
-                    }
-                    list_iterator_start(&(packet->data_frames));
-                    while (list_iterator_hasnext(&(packet->data_frames))){
-                        wr_data_frame_t * current_data = list_iterator_next(&(packet->data_frames));
-                        fwrite(current_data->data, current_data->size, 1, state->file);
-                    }
-                    list_iterator_stop(&(packet->data_frames));
-                }
+                wr_pcap_timeval_set(&(ph.ts), packet->lowlevel_timestamp);
+                memcpy(record, &ph, sizeof(ph));
+                return wr_output_writer_write(&state->writer, record, WR_PCAP_RECORD_HEADERS_SIZE + packet->payload_size);
             }
-            return WR_OK;
 
         case TRANSMISSION_END:
             if (filter->state){
                 wr_pcap_filter_state_t * state = (wr_pcap_filter_state_t * ) filter->state;
-                fclose(state->file);
+                wr_errorcode_t retval = wr_output_writer_close(&state->writer);
                 free(filter->state);
-                return WR_OK;
+                return retval;
             } else {
                 wr_set_error("cannot close file"); 
                 return WR_FATAL;
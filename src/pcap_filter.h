@@ -35,21 +35,55 @@
 #ifndef PCAP_FILTER
 #define PCAP_FILTER
 #include "rtpapi.h"
+#include "output_writer.h"
 /** @defgroup pcap_filter pcap output filter method definitions
  * This is the most essential output filter - pcap filter which convert rtp packets to pcap format and store them into
  * file
+ * Output file is given with "-t" option, it may be redefined with "pcap:filename" option
+ * UDP checksum is zero (not computed) unless "global:udp_checksum" option is set
  *  @{
  */
 
 
 #define TCPDUMP_MAGIC (0xa1b2c3d4)
+
+/**
+ * Size of the link level headers (ETH + IP + UDP) which precede RTP header in the pcap record
+ */
+#define WR_PCAP_LINK_HEADERS_SIZE (14 + 20 + 8)
+
+/**
+ * ETH + IP + UDP headers template, it is built once on TRANSMISSION_START
+ * and shared by pcap and pcapng output filters
+ */
+typedef struct __wr_pcap_link_template {
+    uint8_t headers[WR_PCAP_LINK_HEADERS_SIZE];  /**< headers with zero lengths and checksums */
+    uint16_t ip_sum;            /**< IP checksum of the template, updated with the length of each packet */
+    int udp_checksum;           /**< compute UDP checksums ("global:udp_checksum") */
+    uint32_t udp_sum;           /**< partial sum of the UDP pseudo header and the UDP header template */
+} wr_pcap_link_template_t;
+
 /** 
  * Structure to store internal state of the pcap output filter
  */
 typedef struct __wr_pcap_filter_state {
-    FILE * file; 
+    wr_output_writer_t writer;  /**< buffered output file */
+    wr_pcap_link_template_t link_template;
 } wr_pcap_filter_state_t;
 
+/**
+ * Build headers template from addresses and ports given in the config
+ */
+wr_errorcode_t wr_pcap_link_template_init(wr_pcap_link_template_t * link_template);
+
+/**
+ * Put ETH, IP, UDP and RTP headers of the packet into the frame.
+ * Payload of the packet has to be already stored in the frame after the headers
+ * (at WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t) offset).
+ * @return length of the frame
+ */
+size_t wr_pcap_link_template_fill(const wr_pcap_link_template_t * link_template, uint8_t * frame, wr_rtp_packet_t * packet);
+
 /**
  * Store data into file 
  * This method is invoked when filter is notified
@@ -75,8 +109,19 @@ struct wr_pcap_pkthdr {
     uint32_t len;        	/*< length this packet (off wire) */
 };
 
-#define wr_pcap_timeval_copy(pcap_tv, tv) \
-	{ (pcap_tv)->tv_sec=(tv)->tv_sec; (pcap_tv)->tv_usec=(tv)->tv_usec; }
+/**
+ * Size of all headers which precede RTP payload in the pcap record
+ * (pcap record header + ETH + IP + UDP + RTP)
+ */
+#define WR_PCAP_RECORD_HEADERS_SIZE (sizeof(struct wr_pcap_pkthdr) + WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t))
+
+/**
+ * Size of the ETH + IP + UDP + RTP frame of the packet (as written by #wr_pcap_link_template_fill)
+ */
+#define wr_pcap_frame_size(packet) (WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t) + (packet)->payload_size)
+
+#define wr_pcap_timeval_set(pcap_tv, time) \
+	{ (pcap_tv)->tv_sec=(int32_t)((time) / WR_NSEC_PER_SEC); (pcap_tv)->tv_usec=(int32_t)((time) % WR_NSEC_PER_SEC / WR_NSEC_PER_USEC); }
 /** @} */
 
 #endif
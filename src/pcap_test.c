@@ -67,11 +67,10 @@ int main(int argc, char ** argv)
     /* Create pcap file with just one packet */
     {
         wr_rtp_packet_t p;
-        struct timeval tv = {0,0};
         uint8_t data[] = {0xDE, 0xAD, 0xDE, 0xAD, 0xDE, 0xAD, 0xDE, 0xAD};
         wr_options.output_filename = "testdata/one_packet_test.pcap";
 
-        CHECK( wr_rtp_packet_init(&p, 0, 0, 0, 0, tv) );
+        CHECK( wr_rtp_packet_init(&p, 0, 0, 0, 0, 0) );
         CHECK( wr_rtp_packet_add_frame(&p, data, 8, 1000) );
         CHECK( wr_pcap_filter_notify(&pcap_filter, TRANSMISSION_START, NULL));
         CHECK( wr_pcap_filter_notify(&pcap_filter, NEW_PACKET, &p));
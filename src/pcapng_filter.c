@@ -0,0 +1,261 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcapng_filter.h"
+#include "options.h"
+#include "rtpmap.h"
+
+#define WR_PCAPNG_SECTION_HEADER_BLOCK      0x0A0D0D0A
+#define WR_PCAPNG_INTERFACE_BLOCK           0x00000001
+#define WR_PCAPNG_ENHANCED_PACKET_BLOCK     0x00000006
+#define WR_PCAPNG_BYTE_ORDER_MAGIC          0x1A2B3C4D
+
+#define WR_PCAPNG_OPT_ENDOFOPT      0
+#define WR_PCAPNG_OPT_COMMENT       1
+#define WR_PCAPNG_SHB_USERAPPL      4
+#define WR_PCAPNG_IF_NAME           2
+#define WR_PCAPNG_IF_DESCRIPTION    3
+#define WR_PCAPNG_IF_TSRESOL        9
+
+#define WR_PCAPNG_LINKTYPE_ETHERNET 1
+#define WR_PCAPNG_SNAPLEN           0x0000FFFF
+
+/** block type, total length, interface id, timestamp (high and low), captured and original length */
+#define WR_PCAPNG_EPB_HEADER_SIZE   28
+/** maximum length of the packet comment */
+#define WR_PCAPNG_COMMENT_SIZE      64
+
+#define __pad4(x) (((x) + 3) & ~(size_t)3)
+
+
+
+static uint8_t * __put32(uint8_t * ptr, uint32_t value)
+{
+    memcpy(ptr, &value, 4);
+    return ptr + 4;
+}
+
+
+
+static uint8_t * __put16(uint8_t * ptr, uint16_t value)
+{
+    memcpy(ptr, &value, 2);
+    return ptr + 2;
+}
+
+
+
+/**
+ * Put option (code, length, value padded to 32 bits)
+ */
+static uint8_t * __put_option(uint8_t * ptr, uint16_t code, const void * value, size_t length)
+{
+    ptr = __put16(ptr, code);
+    ptr = __put16(ptr, (uint16_t)length);
+    memcpy(ptr, value, length);
+    memset(ptr + length, 0, __pad4(length) - length);
+    return ptr + __pad4(length);
+}
+
+
+
+/**
+ * Put end of options and total length of the block which begins at the given address,
+ * total length is stored in the block header and in its trailer
+ * @return total length of the block
+ */
+static size_t __finish_block(uint8_t * block, uint8_t * ptr)
+{
+    uint32_t length;
+    ptr = __put32(ptr, WR_PCAPNG_OPT_ENDOFOPT);
+    length = (uint32_t)(ptr - block) + 4;
+    __put32(ptr, length);
+    __put32(block + 4, length);
+    return length;
+}
+
+
+
+static wr_errorcode_t __write_section_header(wr_pcapng_filter_state_t * state)
+{
+    uint8_t block[256];
+    uint8_t * ptr = block;
+    char application[64];
+    snprintf(application, sizeof(application), "wav2rtp %s", VERSION);
+
+    ptr = __put32(ptr, WR_PCAPNG_SECTION_HEADER_BLOCK);
+    ptr = __put32(ptr, 0);
+    ptr = __put32(ptr, WR_PCAPNG_BYTE_ORDER_MAGIC);
+    ptr = __put16(ptr, 1);          /* major version */
+    ptr = __put16(ptr, 0);          /* minor version */
+    ptr = __put32(ptr, 0xffffffff); /* section length is not specified */
+    ptr = __put32(ptr, 0xffffffff);
+    ptr = __put_option(ptr, WR_PCAPNG_SHB_USERAPPL, application, strlen(application));
+    return wr_output_writer_write(&state->writer, block, __finish_block(block, ptr));
+}
+
+
+
+/**
+ * Write interface description block for the payload type
+ */
+static wr_errorcode_t __write_interface(wr_pcapng_filter_state_t * state, int payload_type)
+{
+    uint8_t block[256];
+    uint8_t * ptr = block;
+    char name[32];
+    uint8_t tsresol = 9; /* nanoseconds */
+    wr_encoder_t * encoder = get_encoder_by_pt(payload_type);
+
+    snprintf(name, sizeof(name), "rtp pt %d", payload_type);
+    ptr = __put32(ptr, WR_PCAPNG_INTERFACE_BLOCK);
+    ptr = __put32(ptr, 0);
+    ptr = __put16(ptr, WR_PCAPNG_LINKTYPE_ETHERNET);
+    ptr = __put16(ptr, 0);
+    ptr = __put32(ptr, WR_PCAPNG_SNAPLEN);
+    ptr = __put_option(ptr, WR_PCAPNG_IF_NAME, name, strlen(name));
+    if (encoder && encoder->name)
+        ptr = __put_option(ptr, WR_PCAPNG_IF_DESCRIPTION, encoder->name, strnlen(encoder->name, 64));
+    ptr = __put_option(ptr, WR_PCAPNG_IF_TSRESOL, &tsresol, 1);
+    state->interfaces[payload_type] = state->interfaces_count++;
+    return wr_output_writer_write(&state->writer, block, __finish_block(block, ptr));
+}
+
+
+
+/**
+ * Build enhanced packet block in the output buffer
+ */
+static wr_errorcode_t __write_packet(wr_pcapng_filter_state_t * state, wr_rtp_packet_t * packet)
+{
+    wr_errorcode_t retval;
+    uint8_t * block, * ptr, * frame;
+    size_t frame_len;
+    uint64_t timestamp = (uint64_t)packet->lowlevel_timestamp;
+    size_t max_size = WR_PCAPNG_EPB_HEADER_SIZE + __pad4(WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t) + packet->payload_size) +
+                      4 + WR_PCAPNG_COMMENT_SIZE + 8;
+
+    if ((retval = wr_output_writer_reserve(&state->writer, max_size, &block)) != WR_OK)
+        return retval;
+    frame = block + WR_PCAPNG_EPB_HEADER_SIZE;
+    memcpy(frame + WR_PCAP_LINK_HEADERS_SIZE + sizeof(wr_rtp_header_t), wr_rtp_packet_payload(packet), packet->payload_size);
+    frame_len = wr_pcap_link_template_fill(&state->link_template, frame, packet);
+    memset(frame + frame_len, 0, __pad4(frame_len) - frame_len);
+
+    ptr = __put32(block, WR_PCAPNG_ENHANCED_PACKET_BLOCK);
+    ptr = __put32(ptr, 0);
+    ptr = __put32(ptr, state->interfaces[packet->payload_type]);
+    ptr = __put32(ptr, (uint32_t)(timestamp >> 32));
+    ptr = __put32(ptr, (uint32_t)timestamp);
+    ptr = __put32(ptr, frame_len);
+    ptr = __put32(ptr, frame_len);
+    ptr += __pad4(frame_len);
+    if (state->comments){
+        char comment[WR_PCAPNG_COMMENT_SIZE];
+        int length = snprintf(comment, sizeof(comment), "seq=%d rtp_timestamp=%u", packet->sequence_number, packet->rtp_timestamp);
+        if (length >= (int)sizeof(comment))
+            length = sizeof(comment) - 1;
+        ptr = __put_option(ptr, WR_PCAPNG_OPT_COMMENT, comment, length);
+    }
+    wr_output_writer_commit(&state->writer, __finish_block(block, ptr));
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_pcapng_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event) {
+        case TRANSMISSION_START:
+            {
+                wr_errorcode_t retval;
+                int i;
+                wr_pcapng_filter_state_t * state = calloc(1, sizeof(wr_pcapng_filter_state_t)); 
+                if ((retval = wr_output_writer_open(&state->writer, iniparser_getstring(wr_options.output_options, "pcapng:filename", wr_options.output_filename))) != WR_OK){
+                    free(state);
+                    filter->state = NULL;
+                    return retval;
+                }
+                for (i = 0; i < WR_PCAPNG_MAX_INTERFACES; i++)
+                    state->interfaces[i] = -1;
+                state->comments = iniparser_getboolean(wr_options.output_options, "pcapng:comments", 0);
+                if ((retval = wr_pcap_link_template_init(&state->link_template)) != WR_OK ||
+                    (retval = __write_section_header(state)) != WR_OK){
+                    wr_output_writer_close(&state->writer);
+                    free(state);
+                    return retval;
+                }
+                filter->state = (void*)state;
+                return WR_OK;
+            }
+
+        case NEW_PACKET:
+            {
+                wr_errorcode_t retval;
+                wr_pcapng_filter_state_t * state = (wr_pcapng_filter_state_t * ) filter->state;
+                if (!state){
+                    wr_set_error("internal state of the output filter was not initialized");
+                    return WR_FATAL;
+                }
+                if (packet->payload_type < 0 || packet->payload_type >= WR_PCAPNG_MAX_INTERFACES){
+                    wr_set_error("payload type of the packet is out of range");
+                    return WR_FATAL;
+                }
+                if (state->interfaces[packet->payload_type] < 0 && 
+                    (retval = __write_interface(state, packet->payload_type)) != WR_OK){
+                    return retval;
+                }
+                return __write_packet(state, packet);
+            }
+
+        case TRANSMISSION_END:
+            if (filter->state){
+                wr_pcapng_filter_state_t * state = (wr_pcapng_filter_state_t * ) filter->state;
+                wr_errorcode_t retval = wr_output_writer_close(&state->writer);
+                free(filter->state);
+                return retval;
+            } else {
+                wr_set_error("cannot close file"); 
+                return WR_FATAL;
+            }
+    }
+    return WR_OK;
+}
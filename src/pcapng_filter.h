@@ -0,0 +1,72 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PCAPNG_FILTER
+#define PCAPNG_FILTER
+#include "rtpapi.h"
+#include "output_writer.h"
+#include "pcap_filter.h"
+/** @defgroup pcapng_filter pcapng output filter method definitions
+ * Output filter which stores rtp packets into file in the pcapng format.
+ * Each RTP payload type is a separate interface of the capture (Interface Description Block
+ * is written before the first packet of the payload type), packets are stored in
+ * Enhanced Packet Blocks with nanosecond timestamps.
+ * Output file is given with "-t" option, it may be redefined with "pcapng:filename" option.
+ * With "pcapng:comments" option each packet has a comment with its RTP sequence number and timestamp.
+ *  @{
+ */
+
+/** Maximum number of RTP payload types */
+#define WR_PCAPNG_MAX_INTERFACES 128
+
+/** 
+ * Structure to store internal state of the pcapng output filter
+ */
+typedef struct __wr_pcapng_filter_state {
+    wr_output_writer_t writer;                      /**< buffered output file */
+    wr_pcap_link_template_t link_template;          /**< ETH + IP + UDP headers template */
+    int interfaces[WR_PCAPNG_MAX_INTERFACES];       /**< interface id of each payload type (-1 if it is not written yet) */
+    int interfaces_count;                           /**< number of written interface blocks */
+    int comments;                                   /**< add comments to the packets */
+} wr_pcapng_filter_state_t;
+
+/**
+ * Store data into file 
+ * This method is invoked when filter is notified
+ */
+wr_errorcode_t wr_pcapng_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/** @} */
+
+#endif
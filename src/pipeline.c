@@ -0,0 +1,342 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pipeline.h"
+#include "options.h"
+#include "dummy_filter.h"
+#include "sort_filter.h"
+#include "scheduler_filter.h"
+#include "pcap_filter.h"
+#include "rtpdump_filter.h"
+#include "pcapng_filter.h"
+#include "wavfile_output_filter.h"
+#include "independent_losses_filter.h"
+#include "markov_losses_filter.h"
+#include "gilbert_elliott_filter.h"
+#include "link_filter.h"
+#include "duplicate_reorder_filter.h"
+#include "uniform_delay_filter.h"
+#include "distribution_delay_filter.h"
+#include "correlated_delay_filter.h"
+#include "trace_filter.h"
+#include "gamma_delay_filter.h"
+#include "log_filter.h"
+#include "sipp_filter.h"
+#include "queue_filter.h"
+
+
+#define WR_DEFAULT_PIPELINE "gamma_delay, uniform_delay, distribution_delay, correlated_delay, trace, sort, scheduler, duplicate_reorder, markov_losses, gilbert_elliott, independent_losses, link"
+#define WR_DEFAULT_PCAP_SINKS "log, pcap, wavfile_output, sipp"
+#define WR_DEFAULT_RTPDUMP_SINKS "log, rtpdump, wavfile_output, sipp"
+#define WR_DEFAULT_PCAPNG_SINKS "log, pcapng, wavfile_output, sipp"
+
+
+
+wr_filter_descriptor_t filter_map[] = {
+    {"gamma_delay", "gamma delay intermediate filter", wr_gamma_delay_filter_notify, wr_gamma_delay_filter_notify_batch, 0},
+    {"uniform_delay", "uniform delay intermediate filter", wr_uniform_delay_filter_notify, wr_uniform_delay_filter_notify_batch, 0},
+    {"distribution_delay", "empirical or heavy-tailed delay intermediate filter", wr_distribution_delay_filter_notify, wr_distribution_delay_filter_notify_batch, 0},
+    {"correlated_delay", "correlated delay intermediate filter", wr_correlated_delay_filter_notify, wr_correlated_delay_filter_notify_batch, 0},
+    {"trace", "trace replay intermediate filter", wr_trace_filter_notify, wr_trace_filter_notify_batch, 0},
+    {"sort", "sort filter", wr_sort_filter_notify, wr_sort_filter_notify_batch, 0},
+    {"scheduler", "timing wheel scheduler filter", wr_scheduler_filter_notify, wr_scheduler_filter_notify_batch, 0},
+    {"duplicate_reorder", "duplicate and reorder intermediate filter", wr_duplicate_reorder_filter_notify, wr_duplicate_reorder_filter_notify_batch, 0},
+    {"markov_losses", "markov losses intermediate filter", wr_markov_losses_filter_notify, wr_markov_losses_filter_notify_batch, 0},
+    {"gilbert_elliott", "Gilbert-Elliott losses intermediate filter", wr_gilbert_elliott_filter_notify, wr_gilbert_elliott_filter_notify_batch, 0},
+    {"independent_losses", "independent losses intermediate filter", wr_independent_losses_filter_notify, wr_independent_losses_filter_notify_batch, 0},
+    {"link", "bottleneck link intermediate filter", wr_link_filter_notify, wr_link_filter_notify_batch, 0},
+    {"log", "log filter", wr_log_filter_notify, wr_log_filter_notify_batch, 0},
+    {"pcap", "pcap output filter", wr_pcap_filter_notify, NULL, 0},
+    {"rtpdump", "rtpdump output filter", wr_rtpdump_filter_notify, NULL, 0},
+    {"pcapng", "pcapng output filter", wr_pcapng_filter_notify, NULL, 0},
+    {"wavfile_output", "wavfile output filter", wr_wavfile_output_filter_notify, NULL, 0},
+    {"sipp", "sipp filter", wr_sipp_filter_notify, NULL, 0},
+    {"dummy", "dummy filter", wr_dummy_filter_notify, NULL, 0},
+    {"queue", "queue filter", wr_queue_filter_notify, wr_queue_filter_notify_batch, 1},
+    {NULL, NULL, NULL, NULL, 0}
+};
+
+
+
+wr_filter_descriptor_t * get_filter_by_name(const char * name)
+{
+    int i=0;
+    wr_filter_descriptor_t * pfilter;
+    while((pfilter = &filter_map[i])->name){
+        if (strcmp(pfilter->name, name) == 0){
+            return pfilter;
+        }
+        i++;
+    }
+    return NULL;
+}
+
+
+
+static const char * __stats_format(void)
+{
+    return iniparser_getstring(wr_options.output_options, "global:filter_stats", "off");
+}
+
+
+
+/**
+ * Packets which were received but not sent further, sinks do not drop packets
+ */
+static unsigned long __dropped(wr_rtp_filter_t * filter)
+{
+    if (!filter->observers[0] || filter->stats.packets_in < filter->stats.packets_out)
+        return 0;
+    return filter->stats.packets_in - filter->stats.packets_out;
+}
+
+
+
+static int __is_enabled(const char * name)
+{
+    char key[256];
+    snprintf(key, sizeof(key), "%s:enabled", name);
+    return iniparser_getboolean(wr_options.output_options, key, 1);
+}
+
+
+
+/** How filters of the list are connected */
+typedef enum __wr_append_mode {
+    WR_APPEND_CHAIN,        /**< one after another */
+    WR_APPEND_SINKS,        /**< all of them to the same parent */
+    WR_APPEND_QUEUED_SINKS, /**< all of them to the same parent, each one through its own queue */
+} wr_append_mode_t;
+
+
+
+/**
+ * Instantiate enabled filters from the comma separated list and connect them starting from *last.
+ * *last is set to the last stage of the chain.
+ */
+static wr_errorcode_t __append_filters(wr_pipeline_t * pipeline, const char * list, wr_append_mode_t mode, wr_rtp_filter_t ** last)
+{
+    wr_errorcode_t retval;
+    char message[1024];
+    char * names = strdup(list);
+    char * saveptr = NULL;
+    char * name;
+    wr_rtp_filter_t * parent = *last;
+
+    if (!names){
+        wr_set_error("cannot allocate memory");
+        return WR_FATAL;
+    }
+    for (name = strtok_r(names, ", \t", &saveptr); name; name = strtok_r(NULL, ", \t", &saveptr)){
+        wr_filter_descriptor_t * descriptor = get_filter_by_name(name);
+        wr_rtp_filter_t * filter;
+        wr_rtp_filter_t * attach_to = parent;
+        int i;
+
+        if (!descriptor){
+            snprintf(message, sizeof(message), "unknown filter in the pipeline: %s", name);
+            wr_set_error(message);
+            free(names);
+            return WR_FATAL;
+        }
+        for (i=0; i<pipeline->filters_count && !descriptor->multiple; i++){
+            if (pipeline->filters[i]->notify == descriptor->notify){
+                snprintf(message, sizeof(message), "filter is used in the pipeline twice: %s", name);
+                wr_set_error(message);
+                free(names);
+                return WR_FATAL;
+            }
+        }
+        if (!__is_enabled(name))
+            continue;
+        if (mode == WR_APPEND_QUEUED_SINKS){
+            retval = __append_filters(pipeline, "queue", WR_APPEND_CHAIN, &attach_to);
+            if (retval != WR_OK){
+                free(names);
+                return retval;
+            }
+        }
+        if (pipeline->filters_count == WR_MAX_PIPELINE_FILTERS){
+            wr_set_error("too many filters in the pipeline");
+            free(names);
+            return WR_FATAL;
+        }
+
+        filter = malloc(sizeof(*filter));
+        if (!filter){
+            wr_set_error("cannot allocate memory");
+            free(names);
+            return WR_FATAL;
+        }
+        wr_rtp_filter_create(filter, descriptor->description, descriptor->notify);
+        if (descriptor->notify_batch)
+            wr_rtp_filter_set_notify_batch(filter, descriptor->notify_batch);
+        pipeline->filters[pipeline->filters_count++] = filter;
+
+        wr_rtp_filter_append_observer(attach_to, filter);
+        if (mode == WR_APPEND_CHAIN)
+            parent = filter;
+    }
+    *last = parent;
+    free(names);
+    return WR_OK;
+}
+
+
+
+static char * __default_sinks(void)
+{
+    switch (wr_options.output_format){
+        case WR_OUTPUT_RTPDUMP:
+            return WR_DEFAULT_RTPDUMP_SINKS;
+        case WR_OUTPUT_PCAPNG:
+            return WR_DEFAULT_PCAPNG_SINKS;
+        default:
+            return WR_DEFAULT_PCAP_SINKS;
+    }
+}
+
+
+
+wr_errorcode_t wr_pipeline_build(wr_pipeline_t * pipeline)
+{
+    wr_errorcode_t retval = WR_OK;
+    wr_rtp_filter_t * last = &pipeline->source;
+    int threads = iniparser_getboolean(wr_options.output_options, "global:threads", 0);
+    int parallel_sinks = iniparser_getboolean(wr_options.output_options, "global:parallel_sinks", 0);
+    char * stages = iniparser_getstring(wr_options.output_options, "global:pipeline", WR_DEFAULT_PIPELINE);
+    char * sinks = iniparser_getstring(wr_options.output_options, "global:sinks", __default_sinks());
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    wr_rtp_filter_create(&pipeline->source, "input wav file filter", &wr_do_nothing_on_notify);
+
+    if (threads)
+        retval = __append_filters(pipeline, "queue", WR_APPEND_CHAIN, &last);
+    if (retval == WR_OK)
+        retval = __append_filters(pipeline, stages, WR_APPEND_CHAIN, &last);
+    /* do not put the second queue just after the first one if there are no stages, 
+     * parallel sinks have their own queues */
+    if (retval == WR_OK && threads && !parallel_sinks && pipeline->filters_count > 1)
+        retval = __append_filters(pipeline, "queue", WR_APPEND_CHAIN, &last);
+    if (retval == WR_OK)
+        retval = __append_filters(pipeline, sinks, parallel_sinks ? WR_APPEND_QUEUED_SINKS : WR_APPEND_SINKS, &last);
+    if (retval != WR_OK){
+        wr_pipeline_destroy(pipeline);
+        return retval;
+    }
+
+    if (strcmp(__stats_format(), "table") == 0 || strcmp(__stats_format(), "json") == 0){
+        int i;
+        wr_rtp_filter_enable_stats(&pipeline->source);
+        for (i=0; i<pipeline->filters_count; i++)
+            wr_rtp_filter_enable_stats(pipeline->filters[i]);
+    }
+    return WR_OK;
+}
+
+
+
+static void __print_stats_table(FILE * stream, wr_rtp_filter_t ** filters, int count)
+{
+    int i;
+    fprintf(stream, "%-40s %10s %10s %10s %10s %12s %10s %10s\n", 
+            "filter", "calls", "in", "out", "dropped", "total_us", "ns/packet", "max_ns");
+    for (i=0; i<count; i++){
+        wr_rtp_filter_stats_t * stats = &filters[i]->stats;
+        fprintf(stream, "%-40s %10lu %10lu %10lu %10lu %12.1f %10.1f %10llu\n", 
+                filters[i]->name, stats->calls, stats->packets_in, stats->packets_out, __dropped(filters[i]),
+                stats->total_ns / 1000.0, 
+                stats->packets_in ? (double)stats->total_ns / stats->packets_in : 0.0,
+                (unsigned long long)stats->max_ns);
+    }
+}
+
+
+
+static void __print_stats_json(FILE * stream, wr_rtp_filter_t ** filters, int count)
+{
+    int i;
+    fprintf(stream, "{\"filters\": [\n");
+    for (i=0; i<count; i++){
+        wr_rtp_filter_stats_t * stats = &filters[i]->stats;
+        fprintf(stream, "  {\"name\": \"%s\", \"calls\": %lu, \"packets_in\": %lu, \"packets_out\": %lu, "
+                "\"packets_dropped\": %lu, \"total_ns\": %llu, \"max_ns\": %llu}%s\n", 
+                filters[i]->name, stats->calls, stats->packets_in, stats->packets_out, __dropped(filters[i]),
+                (unsigned long long)stats->total_ns, (unsigned long long)stats->max_ns, 
+                (i == count - 1) ? "" : ",");
+    }
+    fprintf(stream, "]}\n");
+}
+
+
+
+void wr_pipeline_print_stats(wr_pipeline_t * pipeline)
+{
+    wr_rtp_filter_t * filters[WR_MAX_PIPELINE_FILTERS + 1];
+    const char * format = __stats_format();
+    char * filename = iniparser_getstring(wr_options.output_options, "global:filter_stats_file", NULL);
+    FILE * stream = stderr;
+    int i;
+
+    if (!pipeline->source.instrumented)
+        return;
+    filters[0] = &pipeline->source;
+    for (i=0; i<pipeline->filters_count; i++)
+        filters[i + 1] = pipeline->filters[i];
+
+    if (filename && !(stream = fopen(filename, "w"))){
+        fprintf(stderr, "WARNING\tcannot open file %s, filter stats are written to stderr\n", filename);
+        stream = stderr;
+    }
+    if (strcmp(format, "json") == 0)
+        __print_stats_json(stream, filters, pipeline->filters_count + 1);
+    else
+        __print_stats_table(stream, filters, pipeline->filters_count + 1);
+    if (stream != stderr)
+        fclose(stream);
+}
+
+
+
+void wr_pipeline_destroy(wr_pipeline_t * pipeline)
+{
+    int i;
+    for (i=0; i<pipeline->filters_count; i++)
+        free(pipeline->filters[i]);
+    pipeline->filters_count = 0;
+}
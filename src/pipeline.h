@@ -0,0 +1,122 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef __PIPELINE_H
+#define __PIPELINE_H
+
+#include "rtpapi.h"
+
+/** @defgroup pipeline Filter pipeline
+ *  This group describes how the chain of RTP filters is built from the configuration
+ *
+ *  The chain is described with two options of the [global] section of the "output.conf":
+ *
+ *     pipeline = gamma_delay, uniform_delay, distribution_delay, correlated_delay, trace, sort, scheduler, duplicate_reorder, markov_losses, gilbert_elliott, independent_losses, link
+ *     sinks = log, pcap, wavfile_output, sipp
+ *
+ *  Stages of "pipeline" are connected one after another in the given order, the first one receives
+ *  packets from the input wav file, the last one sends packets to every filter in "sinks".
+ *  Filters which are disabled (i.e. "section:enabled" option is false) are not instantiated at all,
+ *  so they do not take part in the transmission.
+ *
+ *  If "global:threads" option is true, queues (see @ref queue_filter) are inserted after the source and
+ *  before the sinks, so encoding, intermediate filters and output filters run in three threads.
+ *  Queues may also be put into the pipeline explicitly as "queue" stage.
+ *  If "global:parallel_sinks" option is true, each sink receives packets through its own queue, so slow
+ *  sinks (e.g. wavfile_output) do not hold back the others.
+ *  @{
+ */
+
+/** Maximum number of filters in the pipeline (stages and sinks together) */
+#define WR_MAX_PIPELINE_FILTERS 32
+
+/**
+ * Filter descriptor
+ */
+typedef struct __wr_filter_descriptor {
+    /** name of the filter, it is also the name of the section in "output.conf" */
+    char * name;
+    /** human readable description */
+    char * description;
+    /** notify callback, see wr_rtp_filter_t#notify */
+    wr_errorcode_t (*notify)(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+    /** batch notify callback (may be NULL), see wr_rtp_filter_t#notify_batch */
+    wr_errorcode_t (*notify_batch)(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+    /** filter may be used in the pipeline more than once */
+    int multiple;
+} wr_filter_descriptor_t;
+
+/**
+ * Filter list
+ */
+extern wr_filter_descriptor_t filter_map[];
+
+/**
+ * Return filter descriptor by its name or NULL if nothing is found
+ */
+wr_filter_descriptor_t * get_filter_by_name(const char * name);
+
+/**
+ * Chain of filters
+ */
+typedef struct __wr_pipeline {
+    /** filter which sends packets of the input file to the first stage */
+    wr_rtp_filter_t source;
+    /** instantiated filters (stages and sinks) */
+    wr_rtp_filter_t * filters[WR_MAX_PIPELINE_FILTERS];
+    /** number of instantiated filters */
+    int filters_count;
+} wr_pipeline_t;
+
+/**
+ * Build chain of filters by the global:pipeline and global:sinks options
+ * @return WR_FATAL if some filter is unknown or is used twice
+ */
+wr_errorcode_t wr_pipeline_build(wr_pipeline_t * pipeline);
+
+/**
+ * Print counters of the filters (see #wr_rtp_filter_stats_t) when the transmission is finished.
+ * Counters are collected if "global:filter_stats" option is "table" or "json", report is written 
+ * to stderr or to the file given by "global:filter_stats_file".
+ */
+void wr_pipeline_print_stats(wr_pipeline_t * pipeline);
+
+/**
+ * Free filters of the pipeline
+ */
+void wr_pipeline_destroy(wr_pipeline_t * pipeline);
+
+/** @} */
+
+#endif
@@ -0,0 +1,412 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prng.h"
+
+
+/** State from which the streams are split, every stream is one jump further than the previous one.
+ * Initial value is the state seeded with 0. */
+static wr_prng_t wr_prng_master = {{0xe220a8397b1dcdafULL, 0x6e789e6aa1b965f4ULL, 0x06c45d188009454fULL, 0xf88bb8a8724c81ecULL}};
+
+
+
+static uint64_t __splitmix64(uint64_t * x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+
+static inline uint64_t __rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+
+
+static inline uint64_t __next(wr_prng_t * prng)
+{
+    uint64_t * s = prng->s;
+    uint64_t result = __rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = __rotl(s[3], 45);
+    return result;
+}
+
+
+
+/**
+ * Upper 53 bits as double from [0, 1)
+ */
+static inline double __uniform(wr_prng_t * prng)
+{
+    return (__next(prng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+
+/**
+ * Full 128-bit product of two 64-bit values from 32-bit halves (no 128-bit type on 32-bit targets)
+ * @return high 64 bits, low 64 bits are stored into low
+ */
+static inline uint64_t __mul_high(uint64_t a, uint64_t b, uint64_t * low)
+{
+    uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t high_low = a_high * b_low;
+    /* does not overflow: at most 2 * (2^32 - 1) + (2^32 - 1)^2 */
+    uint64_t cross = (low_low >> 32) + (uint32_t)high_low + a_low * b_high;
+    *low = (cross << 32) | (uint32_t)low_low;
+    return (high_low >> 32) + (cross >> 32) + a_high * b_high;
+}
+
+
+
+/**
+ * Integer from [0, range) by multiplication (Lemire), rejection removes the bias
+ */
+static inline uint64_t __bounded(wr_prng_t * prng, uint64_t range)
+{
+    uint64_t low;
+    uint64_t high = __mul_high(__next(prng), range, &low);
+    if (low < range){
+        uint64_t threshold = -range % range;
+        while (low < threshold)
+            high = __mul_high(__next(prng), range, &low);
+    }
+    return high;
+}
+
+
+
+/**
+ * Standard normal value (Marsaglia polar method)
+ */
+static double __standard_normal(wr_prng_t * prng)
+{
+    double u, v, s;
+    do {
+        u = 2.0 * __uniform(prng) - 1.0;
+        v = 2.0 * __uniform(prng) - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    return u * sqrt(-2.0 * log(s) / s);
+}
+
+
+
+/**
+ * Gamma value with the scale 1 and shape >= 1 (Marsaglia and Tsang), d = shape - 1/3, c = 1/sqrt(9d)
+ */
+static double __standard_gamma(wr_prng_t * prng, double d, double c)
+{
+    for (;;){
+        double x, v, u;
+        do {
+            x = __standard_normal(prng);
+            v = 1.0 + c * x;
+        } while (v <= 0.0);
+        v = v * v * v;
+        u = __uniform(prng);
+        if (u < 1.0 - 0.0331 * x * x * x * x)
+            return d * v;
+        if (log(u) < 0.5 * x * x + d * (1.0 - v + log(v)))
+            return d * v;
+    }
+}
+
+
+
+void wr_prng_seed(uint64_t seed)
+{
+    int i;
+    for (i=0; i<4; i++)
+        wr_prng_master.s[i] = __splitmix64(&seed);
+}
+
+
+
+void wr_prng_jump(wr_prng_t * prng)
+{
+    static const uint64_t jump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i, b;
+    for (i=0; i<4; i++){
+        for (b=0; b<64; b++){
+            if (jump[i] & ((uint64_t)1 << b)){
+                s0 ^= prng->s[0];
+                s1 ^= prng->s[1];
+                s2 ^= prng->s[2];
+                s3 ^= prng->s[3];
+            }
+            __next(prng);
+        }
+    }
+    prng->s[0] = s0;
+    prng->s[1] = s1;
+    prng->s[2] = s2;
+    prng->s[3] = s3;
+}
+
+
+
+void wr_prng_stream_init(wr_prng_t * prng)
+{
+    static int streams = 0;
+    int i, index = __atomic_fetch_add(&streams, 1, __ATOMIC_RELAXED);
+    *prng = wr_prng_master;
+    for (i=0; i<=index; i++)
+        wr_prng_jump(prng);
+}
+
+
+
+uint64_t wr_prng_next(wr_prng_t * prng)
+{
+    return __next(prng);
+}
+
+
+
+double wr_prng_uniform(wr_prng_t * prng)
+{
+    return __uniform(prng);
+}
+
+
+
+int wr_prng_uniform_int(wr_prng_t * prng, int min, int max)
+{
+    if (max <= min)
+        return min;
+    return (int)(min + (int64_t)__bounded(prng, (uint64_t)((int64_t)max - min) + 1));
+}
+
+
+
+uint64_t wr_prng_geometric(wr_prng_t * prng, double p)
+{
+    uint64_t value;
+    wr_prng_fill_geometric(prng, p, &value, 1);
+    return value;
+}
+
+
+
+double wr_prng_gamma(wr_prng_t * prng, double shape, double scale)
+{
+    double value;
+    wr_prng_fill_gamma(prng, shape, scale, &value, 1);
+    return value;
+}
+
+
+
+void wr_prng_fill_uniform(wr_prng_t * prng, double * values, int count)
+{
+    int i;
+    for (i=0; i<count; i++)
+        values[i] = __uniform(prng);
+}
+
+
+
+void wr_prng_fill_uniform_int(wr_prng_t * prng, int min, int max, int * values, int count)
+{
+    int i;
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    if (max <= min){
+        for (i=0; i<count; i++)
+            values[i] = min;
+        return;
+    }
+    for (i=0; i<count; i++)
+        values[i] = (int)(min + (int64_t)__bounded(prng, range));
+}
+
+
+
+void wr_prng_fill_geometric(wr_prng_t * prng, double p, uint64_t * values, int count)
+{
+    int i;
+    double scale;
+    if (p >= 1.0 || p <= 0.0){
+        for (i=0; i<count; i++)
+            values[i] = (p >= 1.0) ? 0 : UINT64_MAX;
+        return;
+    }
+    /* inversion: floor(log(U) / log(1 - p)), U from (0, 1] */
+    scale = 1.0 / log1p(-p);
+    for (i=0; i<count; i++){
+        double value = floor(log(1.0 - __uniform(prng)) * scale);
+        values[i] = (value < 18446744073709551615.0) ? (uint64_t)value : UINT64_MAX;
+    }
+}
+
+
+
+void wr_prng_fill_gamma(wr_prng_t * prng, double shape, double scale, double * values, int count)
+{
+    int i;
+    /* shape < 1 is boosted: Gamma(a) = Gamma(a + 1) * U^(1/a) */
+    double a = (shape < 1.0) ? shape + 1.0 : shape;
+    double d = a - 1.0 / 3.0;
+    double c = 1.0 / sqrt(9.0 * d);
+    if (shape <= 0.0){
+        for (i=0; i<count; i++)
+            values[i] = 0.0;
+        return;
+    }
+    for (i=0; i<count; i++){
+        double value = __standard_gamma(prng, d, c);
+        if (shape < 1.0)
+            value *= pow(1.0 - __uniform(prng), 1.0 / shape);
+        values[i] = value * scale;
+    }
+}
+
+
+
+double wr_prng_normal(wr_prng_t * prng)
+{
+    return __standard_normal(prng);
+}
+
+
+
+void wr_prng_fill_normal(wr_prng_t * prng, double * values, int count)
+{
+    int i;
+    for (i=0; i<count; i++)
+        values[i] = __standard_normal(prng);
+}
+
+
+
+wr_errorcode_t wr_prng_alias_init(wr_prng_alias_t * table, const double * weights, int count)
+{
+    double sum = 0;
+    int * small, * large;
+    int i, small_count = 0, large_count = 0;
+
+    memset(table, 0, sizeof(*table));
+    for (i=0; i<count; i++){
+        if (weights[i] < 0 || !isfinite(weights[i])){
+            wr_set_error("weights of the distribution have to be non negative");
+            return WR_FATAL;
+        }
+        sum += weights[i];
+    }
+    if (count <= 0 || sum <= 0){
+        wr_set_error("distribution has no values with positive weights");
+        return WR_FATAL;
+    }
+    table->probability = malloc(count * sizeof(double));
+    table->alias = malloc(count * sizeof(int));
+    small = malloc(2 * count * sizeof(int));
+    if (!table->probability || !table->alias || !small){
+        free(small);
+        wr_prng_alias_destroy(table);
+        wr_set_error("cannot allocate memory for the alias table");
+        return WR_FATAL;
+    }
+    large = small + count;
+    table->count = count;
+    /* scaled probabilities, mean is 1 (Vose) */
+    for (i=0; i<count; i++){
+        table->probability[i] = weights[i] * count / sum;
+        table->alias[i] = i;
+        if (table->probability[i] < 1)
+            small[small_count++] = i;
+        else
+            large[large_count++] = i;
+    }
+    while (small_count && large_count){
+        int l = small[--small_count];
+        int g = large[large_count - 1];
+        table->alias[l] = g;
+        table->probability[g] -= 1 - table->probability[l];
+        if (table->probability[g] < 1){
+            large_count--;
+            small[small_count++] = g;
+        }
+    }
+    /* remaining columns are full, up to rounding errors */
+    while (large_count)
+        table->probability[large[--large_count]] = 1;
+    while (small_count)
+        table->probability[small[--small_count]] = 1;
+    free(small);
+    return WR_OK;
+}
+
+
+
+void wr_prng_alias_destroy(wr_prng_alias_t * table)
+{
+    free(table->probability);
+    free(table->alias);
+    memset(table, 0, sizeof(*table));
+}
+
+
+
+int wr_prng_alias_sample(wr_prng_t * prng, const wr_prng_alias_t * table)
+{
+    int column = (int)__bounded(prng, table->count);
+    return (__uniform(prng) < table->probability[column]) ? column : table->alias[column];
+}
+
+
+
+void wr_prng_fill_alias(wr_prng_t * prng, const wr_prng_alias_t * table, int * values, int count)
+{
+    int i;
+    for (i=0; i<count; i++){
+        int column = (int)__bounded(prng, table->count);
+        values[i] = (__uniform(prng) < table->probability[column]) ? column : table->alias[column];
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PRNG_H
+#define PRNG_H
+#include <stdint.h>
+#include "error_types.h"
+
+/** @defgroup prng pseudo random numbers
+ * Fast pseudo random number generator (xoshiro256**) with independent streams.
+ * The generator is seeded once with the "seed" option of the [global] section, each filter
+ * takes its own stream, so the output depends only on the seed and the configuration.
+ * Streams are 2^128 numbers apart (jump function of xoshiro256**), so they never overlap.
+ *  @{
+ */
+
+/** State of one stream */
+typedef struct __wr_prng {
+    uint64_t s[4];
+} wr_prng_t;
+
+/**
+ * Seed the generator, streams taken after this call are derived from the seed
+ */
+void wr_prng_seed(uint64_t seed);
+
+/**
+ * Initialize the next independent stream.
+ * Filters take their streams on TRANSMISSION_START, so streams are assigned in the order of the pipeline.
+ */
+void wr_prng_stream_init(wr_prng_t * prng);
+
+/**
+ * Advance the stream by 2^128 numbers
+ */
+void wr_prng_jump(wr_prng_t * prng);
+
+/**
+ * Return 64 random bits
+ */
+uint64_t wr_prng_next(wr_prng_t * prng);
+
+/**
+ * Return uniformly distributed value from [0, 1)
+ */
+double wr_prng_uniform(wr_prng_t * prng);
+
+/**
+ * Return uniformly distributed integer from [min, max]
+ */
+int wr_prng_uniform_int(wr_prng_t * prng, int min, int max);
+
+/**
+ * Return number of failures before the first success in Bernoulli trials with success probability p
+ * (UINT64_MAX if p is 0)
+ */
+uint64_t wr_prng_geometric(wr_prng_t * prng, double p);
+
+/**
+ * Return gamma distributed value with the given shape and scale (mean is shape * scale)
+ */
+double wr_prng_gamma(wr_prng_t * prng, double shape, double scale);
+
+/**
+ * Return value of the standard normal distribution
+ */
+double wr_prng_normal(wr_prng_t * prng);
+
+/**
+ * Fill array with uniformly distributed values from [0, 1)
+ */
+void wr_prng_fill_uniform(wr_prng_t * prng, double * values, int count);
+
+/**
+ * Fill array with uniformly distributed integers from [min, max]
+ */
+void wr_prng_fill_uniform_int(wr_prng_t * prng, int min, int max, int * values, int count);
+
+/**
+ * Fill array with geometric values, see #wr_prng_geometric
+ */
+void wr_prng_fill_geometric(wr_prng_t * prng, double p, uint64_t * values, int count);
+
+/**
+ * Fill array with gamma distributed values, see #wr_prng_gamma
+ */
+void wr_prng_fill_gamma(wr_prng_t * prng, double shape, double scale, double * values, int count);
+
+/**
+ * Fill array with values of the standard normal distribution
+ */
+void wr_prng_fill_normal(wr_prng_t * prng, double * values, int count);
+
+
+/**
+ * Alias table (Walker, Vose) to draw indices of a discrete distribution in O(1)
+ */
+typedef struct __wr_prng_alias {
+    int count;
+    double * probability;   /**< probability to keep the column */
+    int * alias;            /**< index taken instead of the column */
+} wr_prng_alias_t;
+
+/**
+ * Build alias table of the distribution with the given (non negative, not normalized) weights
+ */
+wr_errorcode_t wr_prng_alias_init(wr_prng_alias_t * table, const double * weights, int count);
+
+/**
+ * Free memory of the alias table
+ */
+void wr_prng_alias_destroy(wr_prng_alias_t * table);
+
+/**
+ * Return random index from the alias table, index i is drawn with probability weights[i] / sum(weights)
+ */
+int wr_prng_alias_sample(wr_prng_t * prng, const wr_prng_alias_t * table);
+
+/**
+ * Fill array with random indices from the alias table
+ */
+void wr_prng_fill_alias(wr_prng_t * prng, const wr_prng_alias_t * table, int * values, int count);
+
+/** @} */
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "prng.h"
+#include "test_sink.h"
+
+
+int main(int argc, char ** argv)
+{
+    wr_prng_t first, second, copy;
+    int i;
+
+    /* the first stream of the seed 2008: xoshiro256** after one jump from the splitmix64 seeded state */
+    {
+        uint64_t expected[] = {0xd8ce9c388d820991ULL, 0xcaf6d583080e5d62ULL, 0x63fc8ec8bf073891ULL, 0x5ca78ae18bba8a04ULL};
+        int expected_int[] = {-531, -433, -91, -149, 154, 781, 641, 748};
+        int expected_full[] = {-1184697399, -1428210197, -1362832671, 1462179439};
+        wr_prng_seed(2008);
+        wr_prng_stream_init(&first);
+        for (i = 0; i < 4; i++)
+            ASSERT(wr_prng_next(&first) == expected[i], "value %d of the stream differs", i);
+        for (i = 0; i < 8; i++)
+            ASSERT(wr_prng_uniform_int(&first, -1000, 1000) == expected_int[i], "integer %d of the stream differs", i);
+        for (i = 0; i < 4; i++)
+            ASSERT(wr_prng_uniform_int(&first, INT_MIN, INT_MAX) == expected_full[i], "integer %d of the full range differs", i);
+    }
+
+    /* the same seed gives the same streams, the next stream is the previous one jumped once */
+    {
+        wr_prng_seed(2008);
+        wr_prng_stream_init(&first);
+        wr_prng_stream_init(&second);
+        copy = first;
+        wr_prng_jump(&copy);
+        ASSERT(memcmp(&copy, &second, sizeof(copy)) == 0, "next stream is not the previous one jumped once");
+        /* wr_prng_seed does not reset the stream counter: copy is the 4th stream, first is the 2nd one */
+        wr_prng_seed(2008);
+        wr_prng_stream_init(&copy);
+        wr_prng_jump(&first);
+        wr_prng_jump(&first);
+        ASSERT(memcmp(&copy, &first, sizeof(copy)) == 0, "stream of the same seed differs");
+        for (i = 0; i < 1000; i++)
+            ASSERT(wr_prng_next(&copy) == wr_prng_next(&first), "stream of the same seed differs at %d", i);
+        wr_prng_seed(2009);
+        wr_prng_stream_init(&copy);
+        wr_prng_jump(&second);
+        wr_prng_jump(&second);
+        ASSERT(wr_prng_next(&copy) != wr_prng_next(&second), "streams of different seeds are equal");
+    }
+
+    /* uniform integers stay within [min, max] and take all values of small ranges */
+    {
+        int ranges[][2] = {{0, 0}, {0, 1}, {-5, 5}, {5, 9}, {-1000, 1000}, {0, INT_MAX}, {INT_MIN, 0}, {INT_MIN, INT_MAX}, {7, 3}};
+        int values[1000];
+        size_t r;
+        for (r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++){
+            int min = ranges[r][0], max = ranges[r][1];
+            int hits[11] = {0};
+            int k;
+            for (k = 0; k < 100; k++){
+                wr_prng_fill_uniform_int(&first, min, max, values, 1000);
+                for (i = 0; i < 1000; i++){
+                    int value = (i & 1) ? values[i] : wr_prng_uniform_int(&first, min, max);
+                    if (max <= min){
+                        ASSERT(value == min, "%d is drawn from empty range [%d, %d]", value, min, max);
+                        continue;
+                    }
+                    ASSERT(value >= min && value <= max, "%d is out of [%d, %d]", value, min, max);
+                    if ((int64_t)max - min <= 10)
+                        hits[value - min]++;
+                }
+            }
+            if (max > min && (int64_t)max - min <= 10){
+                for (i = 0; i <= max - min; i++)
+                    ASSERT(hits[i] > 100000 / (max - min + 1) * 9 / 10, "%d is drawn %d times from [%d, %d]", min + i, hits[i], min, max);
+            }
+        }
+    }
+    return WR_OK;
+}
@@ -0,0 +1,314 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "options.h"
+#include "queue_filter.h"
+
+/** Number of busy-wait iterations before the waiting thread yields the CPU */
+#define WR_QUEUE_SPIN_COUNT 64
+/** Number of yields before the waiting thread sleeps on the condition variable */
+#define WR_QUEUE_YIELD_COUNT 16
+
+
+
+/**
+ * Wait while the counter of the other thread is equal to value.
+ * Thread spins and yields first, then it sleeps until the other thread changes the counter (see #__wake).
+ * Caller checks its condition again after each call.
+ */
+static void __wait(wr_queue_filter_state_t * state, int * spins, unsigned * counter, unsigned value,
+        int * waiting, pthread_cond_t * cond)
+{
+    if (++(*spins) < WR_QUEUE_SPIN_COUNT){
+        __asm__ __volatile__("" ::: "memory");
+        return;
+    }
+    if (*spins < WR_QUEUE_SPIN_COUNT + WR_QUEUE_YIELD_COUNT){
+        sched_yield();
+        return;
+    }
+    pthread_mutex_lock(&state->lock);
+    __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(counter, __ATOMIC_SEQ_CST) == value)
+        pthread_cond_wait(cond, &state->lock);
+    __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&state->lock);
+}
+
+
+
+/**
+ * Wake up the other thread if it sleeps in #__wait. Counter has to be stored before the call.
+ * Mutex is taken only when the other thread sleeps or is going to sleep.
+ */
+static void __wake(wr_queue_filter_state_t * state, int * waiting, pthread_cond_t * cond)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiting, __ATOMIC_RELAXED)){
+        pthread_mutex_lock(&state->lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&state->lock);
+    }
+}
+
+
+
+/**
+ * Make the filled slots visible to the thread of the queue
+ */
+static void __publish(wr_queue_filter_state_t * state)
+{
+    __atomic_store_n(&state->head, state->producer_head, __ATOMIC_RELEASE);
+    __wake(state, &state->consumer_waiting, &state->not_empty);
+}
+
+
+
+/**
+ * Mark the slots as consumed and make them available to the sender
+ */
+static void __consume(wr_queue_filter_state_t * state, unsigned count)
+{
+    __atomic_store_n(&state->tail, state->tail + count, __ATOMIC_RELEASE);
+    __wake(state, &state->producer_waiting, &state->not_full);
+}
+
+
+
+/**
+ * Wait for the free slot in the ring and return it
+ */
+static wr_queue_slot_t * __reserve_slot(wr_queue_filter_state_t * state)
+{
+    int spins = 0;
+    if (state->producer_head - state->producer_tail == state->size){
+        /* ring is full, unpublished slots would never be freed */
+        __publish(state);
+        while ((state->producer_head - 
+                    (state->producer_tail = __atomic_load_n(&state->tail, __ATOMIC_ACQUIRE))) == state->size)
+            __wait(state, &spins, &state->tail, state->producer_tail, &state->producer_waiting, &state->not_full);
+    }
+    return &state->slots[state->producer_head & (state->size - 1)];
+}
+
+
+
+/**
+ * Copy event and packet with its payload to the next slot of the ring (slot is not published)
+ */
+static wr_errorcode_t __push(wr_queue_filter_state_t * state, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    wr_queue_slot_t * slot = __reserve_slot(state);
+    slot->event = event;
+    slot->has_packet = packet ? 1 : 0;
+    if (packet){
+        wr_rtp_buffer_t * buffer = slot->packet.buffer;
+        if (!buffer){
+            if (wr_rtp_packet_init(&slot->packet, 0, 0, 0, 0, 0)){
+                wr_set_error("cannot allocate payload buffer of the packet");
+                return WR_FATAL;
+            }
+            buffer = slot->packet.buffer;
+        }
+        wr_rtp_packet_copy(&slot->packet, packet);
+        slot->packet.buffer = buffer;
+        slot->packet.pool = NULL;
+        slot->packet.payload_size = 0;
+        if (wr_rtp_packet_reserve(&slot->packet, packet->payload_size) != WR_OK)
+            return WR_FATAL;
+        memcpy(wr_rtp_packet_payload(&slot->packet), wr_rtp_packet_payload(packet), packet->payload_size);
+        slot->packet.payload_size = packet->payload_size;
+    }
+    state->producer_head++;
+    return WR_OK;
+}
+
+
+
+/**
+ * Prepare slot to be reused by the sender.
+ * If observers have kept a reference to the payload, the buffer is left to them.
+ */
+static void __reclaim(wr_queue_slot_t * slot)
+{
+    if (slot->has_packet && slot->packet.buffer && slot->packet.buffer->refcount > 1){
+        wr_rtp_buffer_unref(slot->packet.buffer);
+        slot->packet.buffer = NULL;
+    }
+}
+
+
+
+static void __destroy_sync(wr_queue_filter_state_t * state)
+{
+    pthread_cond_destroy(&state->not_full);
+    pthread_cond_destroy(&state->not_empty);
+    pthread_mutex_destroy(&state->lock);
+}
+
+
+
+static void * __queue_thread(void * arg)
+{
+    wr_rtp_filter_t * filter = (wr_rtp_filter_t *)arg;
+    wr_queue_filter_state_t * state = (wr_queue_filter_state_t *)filter->state;
+    unsigned mask = state->size - 1;
+    int finished = 0;
+
+    while (!finished){
+        wr_queue_slot_t * slot;
+        int spins = 0;
+        unsigned available, i;
+
+        while (!(available = state->consumer_head - state->tail)){
+            state->consumer_head = __atomic_load_n(&state->head, __ATOMIC_ACQUIRE);
+            if (state->consumer_head == state->tail)
+                __wait(state, &spins, &state->head, state->tail, &state->consumer_waiting, &state->not_empty);
+        }
+
+        slot = &state->slots[state->tail & mask];
+        if (slot->event == NEW_PACKET){
+            wr_rtp_packet_t * packets[WR_MAX_BATCH_SIZE];
+            unsigned count = 0;
+            while (count < available && count < WR_MAX_BATCH_SIZE){
+                wr_queue_slot_t * next = &state->slots[(state->tail + count) & mask];
+                if (next->event != NEW_PACKET)
+                    break;
+                packets[count++] = &next->packet;
+            }
+            wr_rtp_filter_notify_observers_batch(filter, packets, count);
+            for (i=0; i<count; i++)
+                __reclaim(&state->slots[(state->tail + i) & mask]);
+            __consume(state, count);
+        } else {
+            wr_rtp_filter_notify_observers(filter, slot->event, slot->has_packet ? &slot->packet : NULL);
+            finished = (slot->event == TRANSMISSION_END);
+            __reclaim(slot);
+            __consume(state, 1);
+        }
+    }
+    return NULL;
+}
+
+
+
+wr_errorcode_t wr_queue_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_queue_filter_state_t * state = calloc(1, sizeof(*state));
+            int queue_size = iniparser_getpositiveint(wr_options.output_options, "global:queue_size", 1024);
+            if (!state){
+                wr_set_error("cannot allocate memory");
+                return WR_FATAL;
+            }
+            state->size = WR_QUEUE_MIN_SIZE;
+            while (state->size < (unsigned)queue_size)
+                state->size <<= 1;
+            state->slots = calloc(state->size, sizeof(wr_queue_slot_t));
+            if (!state->slots){
+                free(state);
+                wr_set_error("cannot allocate memory");
+                return WR_FATAL;
+            }
+            pthread_mutex_init(&state->lock, NULL);
+            pthread_cond_init(&state->not_empty, NULL);
+            pthread_cond_init(&state->not_full, NULL);
+            filter->state = (void*)state;
+            if (__push(state, event, packet) != WR_OK)
+                return WR_FATAL;
+            __publish(state);
+            if (pthread_create(&state->thread, NULL, &__queue_thread, filter)){
+                __destroy_sync(state);
+                free(state->slots);
+                free(state);
+                filter->state = NULL;
+                wr_set_error("cannot create thread of the queue");
+                return WR_FATAL;
+            }
+            return WR_OK;
+        }
+        case NEW_PACKET: {
+            wr_queue_filter_state_t * state = (wr_queue_filter_state_t * ) (filter->state);
+            wr_errorcode_t retval;
+            if (!state){
+                wr_set_error("queue is not started");
+                return WR_FATAL;
+            }
+            retval = __push(state, event, packet);
+            __publish(state);
+            return retval;
+        }
+        case TRANSMISSION_END: {
+            wr_queue_filter_state_t * state = (wr_queue_filter_state_t * ) (filter->state);
+            unsigned i;
+            if (!state)
+                return WR_OK;
+            __push(state, event, NULL);
+            __publish(state);
+            pthread_join(state->thread, NULL);
+            for (i=0; i<state->size; i++){
+                if (state->slots[i].packet.buffer)
+                    wr_rtp_packet_destroy(&state->slots[i].packet);
+            }
+            __destroy_sync(state);
+            free(state->slots);
+            free(state);
+            filter->state = NULL;
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_queue_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_queue_filter_state_t * state = (wr_queue_filter_state_t * ) (filter->state);
+    wr_errorcode_t retval = WR_OK;
+    int i;
+    if (!state){
+        wr_set_error("queue is not started");
+        return WR_FATAL;
+    }
+    for (i=0; i<count && retval == WR_OK; i++)
+        retval = __push(state, NEW_PACKET, packets[i]);
+    __publish(state);
+    return retval;
+}
@@ -0,0 +1,114 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef QUEUE_FILTER_H
+#define QUEUE_FILTER_H
+#include <pthread.h>
+#include "rtpapi.h"
+
+/** @defgroup queue_filter queue filter
+ * This filter is a thread boundary: all events it receives are passed through a bounded
+ * single-producer/single-consumer ring to its own thread, which notifies observers of the filter.
+ * Filters before and after the queue run concurrently.
+ *
+ * Events keep their order, TRANSMISSION_END returns only when observers of the queue have processed
+ * all events (the thread is joined), so a transmission looks the same for the source as without
+ * the queue. When the ring is full the sender waits (backpressure). Waiting thread (the sender on the
+ * full ring or the thread of the queue on the empty one) spins, then yields the CPU, then sleeps
+ * on the condition variable until the other thread publishes or consumes slots.
+ *
+ * Packets are copied into the ring with their payload, so the sender may reuse them as soon as notify
+ * returns. Packets which are kept by observers after notify returns (e.g. by the sort filter) hold
+ * their payload buffer and the ring slot gets a new one.
+ *
+ * Queues are inserted into the pipeline by "global:threads" option or explicitly as "queue" stage.
+ * It uses option "global:queue_size" (number of slots in the ring, default 1024).
+ *  @{
+ */
+
+/** Minimal number of slots in the ring */
+#define WR_QUEUE_MIN_SIZE (2 * WR_MAX_BATCH_SIZE)
+
+/**
+ * Slot of the ring
+ */
+typedef struct __wr_queue_slot {
+    wr_event_type_t event;
+    int has_packet;             /**< packet is set (TRANSMISSION_END has no packet) */
+    wr_rtp_packet_t packet;     /**< packet with its own payload buffer */
+} wr_queue_slot_t;
+
+/** 
+ * Structure to store internal state of the queue filter
+ * head and tail counters grow infinitely, slot index is counter & (size - 1)
+ */
+typedef struct __wr_queue_filter_state {
+    wr_queue_slot_t * slots;
+    unsigned size;              /**< number of slots, power of two */
+    pthread_t thread;
+
+    /* written by the sender, padding keeps counters of both threads in different cache lines */
+    char padding1[64];
+    unsigned head;              /**< number of published slots */
+    unsigned producer_head;     /**< number of filled slots, some of them may be not published yet */
+    unsigned producer_tail;     /**< cached value of tail */
+
+    /* written by the thread of the queue */
+    char padding2[64];
+    unsigned tail;              /**< number of consumed slots */
+    unsigned consumer_head;     /**< cached value of head */
+
+    /* used only when one of the threads sleeps */
+    char padding3[64];
+    int producer_waiting;       /**< sender sleeps on not_full */
+    int consumer_waiting;       /**< thread of the queue sleeps on not_empty */
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    char padding4[64];
+} wr_queue_filter_state_t;
+
+/**
+ * Put event to the ring, start thread at TRANSMISSION_START and join it at TRANSMISSION_END
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_queue_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_queue_filter_notify, slots are published once per batch
+ */
+wr_errorcode_t wr_queue_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -33,6 +33,8 @@
  *
  */
 #include "rtpapi.h"
+#include "packet_pool.h"
+#include "misc.h"
 #include "contrib/simclist.h"
 #include <stdlib.h>
 #ifdef _WIN32
@@ -45,15 +47,20 @@
 
 void wr_rtp_header_init(wr_rtp_header_t * rtp_header, wr_rtp_packet_t * rtp_packet)
 {
-    static int ssrc = 0;
-    if (ssrc == 0)
-        ssrc = (rand() << 16) | (rand() & 0xffff);
+    static uint32_t ssrc = 0;
+    /* output filters may run in parallel threads, all of them have to use the same ssrc */
+    uint32_t value = __atomic_load_n(&ssrc, __ATOMIC_ACQUIRE);
+    if (value == 0){
+        uint32_t candidate = ((uint32_t)rand() << 16) | ((uint32_t)rand() & 0xffff);
+        if (__atomic_compare_exchange_n(&ssrc, &value, candidate, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            value = candidate;
+    }
     memset(rtp_header, 0, sizeof(*rtp_header));
     rtp_header->version = 2;
     rtp_header->padbit = 0;
     rtp_header->extbit = 0;
     rtp_header->cc = 0;
-    rtp_header->ssrc = ssrc;
+    rtp_header->ssrc = value;
     rtp_header->markbit = rtp_packet->markbit;
     rtp_header->paytype = rtp_packet->payload_type;
     rtp_header->seq_number = htons(rtp_packet->sequence_number);
@@ -61,16 +68,51 @@ void wr_rtp_header_init(wr_rtp_header_t * rtp_header, wr_rtp_packet_t * rtp_pack
 }
 
 
-int wr_rtp_packet_init(wr_rtp_packet_t * rtp_packet, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, struct timeval lowlevel_timestamp)
+/**
+ * Allocate buffer with refcount 1 from the given pool (or from the heap if pool is NULL)
+ */
+static wr_rtp_buffer_t * __buffer_new(struct __wr_packet_pool * pool, size_t capacity)
+{
+    wr_rtp_buffer_t * buffer;
+    if (pool)
+        return wr_packet_pool_get_buffer(pool, capacity);
+    buffer = malloc(sizeof(wr_rtp_buffer_t) + WR_RTP_PACKET_HEADROOM + capacity);
+    if (!buffer)
+        return NULL;
+    buffer->refcount = 1;
+    buffer->capacity = capacity;
+    buffer->pool = NULL;
+    buffer->next_free = NULL;
+    return buffer;
+}
+
+
+
+void wr_rtp_buffer_unref(wr_rtp_buffer_t * buffer)
+{
+    if (!buffer || --buffer->refcount > 0)
+        return;
+    if (buffer->pool)
+        wr_packet_pool_put_buffer(buffer->pool, buffer);
+    else
+        free(buffer);
+}
+
+
+
+int wr_rtp_packet_init(wr_rtp_packet_t * rtp_packet, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, wr_time_t lowlevel_timestamp)
 {
     rtp_packet->payload_type = payload_type;
     rtp_packet->sequence_number = sequence_number;
     rtp_packet->rtp_timestamp = rtp_timestamp;
-    rtp_packet->lowlevel_timestamp.tv_sec = lowlevel_timestamp.tv_sec;
-    rtp_packet->lowlevel_timestamp.tv_usec = lowlevel_timestamp.tv_usec;
+    rtp_packet->lowlevel_timestamp = lowlevel_timestamp;
     rtp_packet->markbit = markbit;
-    list_init(&rtp_packet->data_frames);
-    return 0;
+    rtp_packet->frames_count = 0;
+    rtp_packet->payload_size = 0;
+    rtp_packet->pool = NULL;
+    /* headroom is always available, even for the empty packet */
+    rtp_packet->buffer = __buffer_new(NULL, 0);
+    return rtp_packet->buffer ? 0 : 1;
 }
 
 
@@ -83,16 +125,24 @@ int wr_rtp_packet_copy(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packe
 
 
 
+int wr_rtp_packet_share(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packet)
+{
+    wr_rtp_packet_copy(new_packet, old_packet);
+    new_packet->pool = NULL;
+    new_packet->buffer->refcount++;
+    return 0;
+}
+
+
+
 int wr_rtp_packet_copy_with_data(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packet)
 {
     wr_rtp_packet_copy(new_packet, old_packet);
-    list_init(&new_packet->data_frames);
-    list_iterator_start(&old_packet->data_frames);
-    while(list_iterator_hasnext(&old_packet->data_frames)){
-        wr_data_frame_t * frame = (wr_data_frame_t * ) list_iterator_next(&old_packet->data_frames);
-        wr_rtp_packet_add_frame(new_packet, frame->data, frame->size, frame->length_in_ms);
-    }
-    list_iterator_stop(&old_packet->data_frames);
+    new_packet->pool = NULL;
+    new_packet->buffer = __buffer_new(old_packet->buffer->pool, old_packet->payload_size);
+    if (!new_packet->buffer)
+        return 1;
+    memcpy(wr_rtp_packet_payload(new_packet), wr_rtp_packet_payload(old_packet), old_packet->payload_size);
     return 0;
 }
 
@@ -100,27 +150,51 @@ int wr_rtp_packet_copy_with_data(wr_rtp_packet_t * new_packet, wr_rtp_packet_t *
 
 void wr_rtp_packet_destroy(wr_rtp_packet_t * rtp_packet)
 {
-    list_iterator_start(&rtp_packet->data_frames);
-    while(list_iterator_hasnext(&rtp_packet->data_frames)){
-        wr_data_frame_t * frame = (wr_data_frame_t * ) list_iterator_next(&rtp_packet->data_frames);
-        free(frame->data);
-        free(frame);
+    wr_rtp_buffer_unref(rtp_packet->buffer);
+    rtp_packet->buffer = NULL;
+    rtp_packet->payload_size = 0;
+    rtp_packet->frames_count = 0;
+}
+
+
+
+wr_errorcode_t wr_rtp_packet_reserve(wr_rtp_packet_t * packet, size_t size)
+{
+    size_t capacity;
+    wr_rtp_buffer_t * buffer;
+    if (packet->buffer->refcount == 1 && size <= packet->buffer->capacity)
+        return WR_OK;
+    capacity = packet->buffer->capacity;
+    if (capacity < size)
+        capacity = (capacity * 2 > size) ? capacity * 2 : size;
+    buffer = __buffer_new(packet->buffer->pool, capacity);
+    if (!buffer){
+        wr_set_error("cannot allocate payload buffer of the packet");
+        return WR_FATAL;
     }
-    list_iterator_stop(&rtp_packet->data_frames);
-    list_destroy(&rtp_packet->data_frames);
+    memcpy(buffer->data, packet->buffer->data, WR_RTP_PACKET_HEADROOM + packet->payload_size);
+    wr_rtp_buffer_unref(packet->buffer);
+    packet->buffer = buffer;
+    return WR_OK;
 }
 
 
 
 wr_errorcode_t wr_rtp_packet_add_frame(wr_rtp_packet_t * packet, uint8_t * data, size_t size, int length_in_ms)
 {
-    /* XXX: no checks for calloc unsucessfull call */
-    wr_data_frame_t * frame = calloc(1, sizeof(wr_data_frame_t));    
-    frame->data = calloc(size, sizeof(uint8_t));
-    memcpy(frame->data, data, size * sizeof(uint8_t));
+    wr_data_frame_t * frame;
+    if (packet->frames_count >= WR_MAX_DATA_FRAMES){
+        wr_set_error("too many data frames in one rtp packet");
+        return WR_FATAL;
+    }
+    if (wr_rtp_packet_reserve(packet, packet->payload_size + size) != WR_OK)
+        return WR_FATAL;
+    frame = &packet->data_frames[packet->frames_count++];
+    frame->offset = packet->payload_size;
     frame->size = size;
     frame->length_in_ms = length_in_ms;
-    list_append(&packet->data_frames, frame);
+    memcpy(wr_data_frame_data(packet, frame), data, size * sizeof(uint8_t));
+    packet->payload_size += size;
     return WR_OK; 
 }
 
@@ -128,7 +202,25 @@ wr_errorcode_t wr_rtp_packet_add_frame(wr_rtp_packet_t * packet, uint8_t * data,
 
 int wr_rtp_packet_delete_frame(wr_rtp_packet_t * packet, int position)
 {
-    /* XXX: Not yet implemented */
+    int i;
+    uint8_t * data;
+    size_t size, tail;
+    if (position == -1)
+        position = packet->frames_count - 1;
+    if (position < 0 || position >= packet->frames_count)
+        return 1;
+    if (wr_rtp_packet_reserve(packet, packet->payload_size) != WR_OK)
+        return 1;
+    data = wr_data_frame_data(packet, &packet->data_frames[position]);
+    size = packet->data_frames[position].size;
+    tail = packet->payload_size - packet->data_frames[position].offset - size;
+    memmove(data, data + size, tail);
+    packet->payload_size -= size;
+    for (i=position+1; i<packet->frames_count; i++){
+        packet->data_frames[i-1] = packet->data_frames[i];
+        packet->data_frames[i-1].offset -= size;
+    }
+    packet->frames_count--;
     return 0;
 }
 
@@ -143,6 +235,23 @@ void wr_rtp_filter_create(wr_rtp_filter_t * filter, char *name,
 
 
 
+void wr_rtp_filter_set_notify_batch(wr_rtp_filter_t * filter, 
+        wr_errorcode_t (*notify_batch)(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+    )
+{
+    filter->notify_batch = notify_batch;
+}
+
+
+
+void wr_rtp_filter_enable_stats(wr_rtp_filter_t * filter)
+{
+    memset(&filter->stats, 0, sizeof(filter->stats));
+    filter->instrumented = 1;
+}
+
+
+
 void wr_rtp_filter_append_observer(wr_rtp_filter_t * filter, wr_rtp_filter_t * observer)
 {
     int i;
@@ -157,24 +266,99 @@ void wr_rtp_filter_append_observer(wr_rtp_filter_t * filter, wr_rtp_filter_t * o
 
 
 
+static void __report_notify_error(wr_rtp_filter_t * filter, wr_errorcode_t retval)
+{
+    switch(retval){
+        case WR_FATAL: 
+            fprintf(stderr, "%s\t%s: %s\n", "FATAL", filter->name, wr_error); 
+            break;
+        case WR_WARN:
+            fprintf(stderr, "%s\t%s: %s\n",  "WARNING", filter->name, wr_error); 
+            break;
+        default:
+            break;
+    }
+}
+
+
+
+/**
+ * Time spent in the observers of the filter which is notified now (per thread).
+ * It is subtracted from the time of the filter, so each filter is charged only for its own work.
+ */
+static __thread uint64_t __observers_ns;
+
+/**
+ * Notify instrumented observer with one packet or with the batch of packets
+ */
+static wr_errorcode_t __notify_instrumented(wr_rtp_filter_t * observer, wr_rtp_packet_t ** packets, int count, int batch)
+{
+    wr_errorcode_t retval;
+    uint64_t saved_observers_ns = __observers_ns;
+    uint64_t start, elapsed, self;
+
+    __observers_ns = 0;
+    start = wr_clock_ns();
+    if (batch)
+        retval = (*observer->notify_batch)(observer, packets, count);
+    else
+        retval = (*observer->notify)(observer, NEW_PACKET, packets[0]);
+    elapsed = wr_clock_ns() - start;
+    self = elapsed - __observers_ns;
+    __observers_ns = saved_observers_ns + elapsed;
+
+    observer->stats.calls++;
+    observer->stats.packets_in += count;
+    observer->stats.total_ns += self;
+    if (self > observer->stats.max_ns)
+        observer->stats.max_ns = self;
+    return retval;
+}
+
+
+
 void wr_rtp_filter_notify_observers(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
 {
     int i;
+    if (event == NEW_PACKET && filter->instrumented)
+        filter->stats.packets_out++;
     for (i=0; i<MAX_OBSERVERS; i++){
-        wr_errorcode_t retval;
         wr_rtp_filter_t * observer = filter->observers[i];
         if (!observer) break;
-        retval = (*observer->notify)(observer, event, packet);
-        switch(retval){
-            case WR_FATAL: 
-                fprintf(stderr, "%s\t%s: %s\n", "FATAL", filter->name, wr_error); 
-                break;
-            case WR_WARN:
-                fprintf(stderr, "%s\t%s: %s\n",  "WARNING", filter->name, wr_error); 
-                break;
-            default:
-                break;
+        if (event == NEW_PACKET && observer->instrumented)
+            __report_notify_error(filter, __notify_instrumented(observer, &packet, 1, 0));
+        else
+            __report_notify_error(filter, (*observer->notify)(observer, event, packet));
+    }
+}
+
+
+
+void wr_rtp_filter_notify_observers_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    int i, j;
+    if (count <= 0)
+        return;
+    if (filter->instrumented)
+        filter->stats.packets_out += count;
+    for (i=0; i<MAX_OBSERVERS; i++){
+        wr_rtp_filter_t * observer = filter->observers[i];
+        if (!observer) break;
+        if (observer->instrumented){
+            if (observer->notify_batch){
+                __report_notify_error(filter, __notify_instrumented(observer, packets, count, 1));
+                continue;
+            }
+            for (j=0; j<count; j++)
+                __report_notify_error(filter, __notify_instrumented(observer, &packets[j], 1, 0));
+            continue;
+        }
+        if (observer->notify_batch){
+            __report_notify_error(filter, (*observer->notify_batch)(observer, packets, count));
+            continue;
         }
+        for (j=0; j<count; j++)
+            __report_notify_error(filter, (*observer->notify)(observer, NEW_PACKET, packets[j]));
     }
 }
 
@@ -39,6 +39,7 @@
 #include <sys/time.h>
 #include "error_types.h"
 #include "options.h"
+#include "misc.h"
 #ifdef HAVE_CONFIG_H
     #include <config.h>
 #endif
@@ -79,29 +80,72 @@ typedef struct __wr_rtp_header
 #pragma pack()
 
 
+struct __wr_packet_pool;
+
 /**
- * RTP data packet which contains link to the set of rtp data frames 
+ * Maximum number of data frames in one RTP packet
  */
-typedef struct __wr_rtp_packet {
-    int payload_type;                   /**< payload type of the packet */
-    int sequence_number;                /**< sequence number */
-    int markbit;                        /**< markbit is set to on/off */
-    struct timeval lowlevel_timestamp;  /**< low-level (physical) timestamp, i.e. timestamp when packet actually received */
-    uint32_t rtp_timestamp;             /**< RTP packet timestamp */
-    list_t data_frames;                 /**< list of data frames (wr_data_frame_t objects ) */
-} wr_rtp_packet_t; 
+#define WR_MAX_DATA_FRAMES 32
+
+/**
+ * Number of bytes reserved in front of the payload of each packet.
+ * Output filters use it to put record and protocol headers
+ * (pcap record header + ETH + IP + UDP + RTP) just before the payload, so
+ * the whole record may be written at once.
+ */
+#define WR_RTP_PACKET_HEADROOM 80
 
 /** 
- * Data frame object
+ * Data frame descriptor
+ * Data of the frame is stored in the payload buffer of its packet, use #wr_data_frame_data to get it.
  * Note that you may use more than one wr_data_frame_t in RTP packet
  */
 typedef struct __wr_data_frame {
     int length_in_ms;              /**< size of data in ms */
     size_t size;                   /**< size of data */
-    uint8_t * data;                /**< pointer to the data */
+    size_t offset;                 /**< offset of the data from the beginning of the packet payload */
 } wr_data_frame_t;
 
 
+/**
+ * Reference counted payload buffer
+ * One buffer may be shared by several packets which differ only in their metadata
+ * (see #wr_rtp_packet_share), it is released when the last of them is destroyed.
+ */
+typedef struct __wr_rtp_buffer {
+    int refcount;                       /**< number of packets which use this buffer */
+    size_t capacity;                    /**< maximum payload size which buffer can hold */
+    struct __wr_packet_pool * pool;     /**< pool which owns the buffer (NULL if it is allocated on the heap) */
+    struct __wr_rtp_buffer * next_free; /**< next buffer in the free list of the pool */
+    uint8_t data[];                     /**< WR_RTP_PACKET_HEADROOM bytes followed by the payload */
+} wr_rtp_buffer_t;
+
+
+/**
+ * RTP data packet
+ * Data frames of the packet are stored one after another in one contiguous payload buffer
+ * which is preceded by WR_RTP_PACKET_HEADROOM bytes of free space.
+ */
+typedef struct __wr_rtp_packet {
+    int payload_type;                   /**< payload type of the packet */
+    int sequence_number;                /**< sequence number */
+    int markbit;                        /**< markbit is set to on/off */
+    wr_time_t lowlevel_timestamp;       /**< low-level (physical) timestamp in nanoseconds, i.e. timestamp when packet actually received */
+    uint32_t rtp_timestamp;             /**< RTP packet timestamp */
+    int frames_count;                   /**< number of used data_frames */
+    wr_data_frame_t data_frames[WR_MAX_DATA_FRAMES]; /**< descriptors of data frames */
+    wr_rtp_buffer_t * buffer;           /**< headroom and payload, may be shared with other packets */
+    size_t payload_size;                /**< total size of the data frames */
+    struct __wr_packet_pool * pool;     /**< pool which owns the packet (NULL if it is allocated by the user) */
+} wr_rtp_packet_t; 
+
+/** pointer to the first byte of the packet payload */
+#define wr_rtp_packet_payload(packet) ((packet)->buffer->data + WR_RTP_PACKET_HEADROOM)
+
+/** pointer to the data of the given frame of the packet */
+#define wr_data_frame_data(packet, frame) (wr_rtp_packet_payload(packet) + (frame)->offset)
+
+
 /**
  * initialize rtp header
  */
@@ -111,30 +155,55 @@ void wr_rtp_header_init(wr_rtp_header_t * rtp_header, wr_rtp_packet_t * rtp_pack
  * initialize rtp packet
  * @return 0 if all OK, 1 oherwise
  */
-int wr_rtp_packet_init(wr_rtp_packet_t * rtp_packet, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, struct timeval lowlevel_timestamp);
+int wr_rtp_packet_init(wr_rtp_packet_t * rtp_packet, int payload_type, int sequence_number, int markbit, uint32_t rtp_timestamp, wr_time_t lowlevel_timestamp);
 
-/** destroy rtp packet */
+/**
+ * destroy rtp packet (drop its reference to the payload buffer)
+ * Packets taken from the packet pool have to be returned with #wr_packet_pool_release instead
+ */
 void wr_rtp_packet_destroy(wr_rtp_packet_t * rtp_packet);
 
 /**
- * Copy existing rtp packet metadata ("data" member of the new packet picks to the same place as "data" of the old
- * packet).
- * This packet should not be destroyed via #wr_rtp_packet_destroy
+ * Copy existing rtp packet metadata (payload buffer of the new packet points to the same place as the buffer of the
+ * old packet, no reference is taken).
+ * This packet should not be destroyed via #wr_rtp_packet_destroy and cannot outlive the old packet
+ * (use it to alter metadata of the packet until notify returns).
  */
 int wr_rtp_packet_copy(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packet);
 
 /**
- * Copy existing rtp packet metadata and data ("data" member of the new packet is copied from the "data" of the old packet).
+ * Copy existing rtp packet metadata and take a reference to its payload buffer.
+ * Payload is not copied: it is copied only if one of the packets adds data to it.
+ * This packet should be destroyed via #wr_rtp_packet_destroy
+ */
+int wr_rtp_packet_share(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packet);
+
+/**
+ * Copy existing rtp packet metadata and data (new packet gets its own copy of the payload buffer).
  * This packet should be destroyed via #wr_rtp_packet_destroy
  */
 int wr_rtp_packet_copy_with_data(wr_rtp_packet_t * new_packet, wr_rtp_packet_t * old_packet);
 
 /** 
  * add data frame to the packet
- * This create new data frame and add this frame to rtp packet
+ * This appends data to the payload of the packet and adds descriptor of the new frame
+ * @return WR_FATAL if packet already contains WR_MAX_DATA_FRAMES frames or memory cannot be allocated
  */
 wr_errorcode_t wr_rtp_packet_add_frame(wr_rtp_packet_t * packet, uint8_t * data, size_t size, int length_in_ms);
 
+/**
+ * Make sure that payload buffer of the packet can hold at least size bytes
+ * and is not shared with other packets (copy-on-write).
+ * Headroom is always reserved in addition to this size.
+ */
+wr_errorcode_t wr_rtp_packet_reserve(wr_rtp_packet_t * packet, size_t size);
+
+/**
+ * Drop one reference to the buffer, buffer is freed (or returned to its pool)
+ * when there are no references left
+ */
+void wr_rtp_buffer_unref(wr_rtp_buffer_t * buffer);
+
 
 /** 
  * remove data from rtp packet at selected position
@@ -156,10 +225,18 @@ int wr_rtp_packet_delete_frame(wr_rtp_packet_t * packet, int position);
  *  If event type is NEW_PACKET then third parameter is set to pointer to the #wr_rtp_packet_t object
  *
  *  Intermediate filter (i.e. loss emulator) should copy its input RTP packet, then alter (if to needs to do it) *copyed* object and 
- *  invoke "notify_observers" with this object.
+ *  invoke "notify_observers" with this object. Filters which change only metadata of the packet (i.e. delay emulators)
+ *  should use #wr_rtp_packet_copy, filters which keep packets after notify returns (i.e. sort filter) should take
+ *  a reference with #wr_rtp_packet_share. Payload of the packet is never copied in both cases.
  *
  *  Filter cannot assume that link to packet which it receive via notify rest unchanged or not be removed at all.
  *
+ *  Besides, filter may implement wr_rtp_filter_t#notify_batch which receives a batch of new packets (up to
+ *  #WR_MAX_BATCH_SIZE) at once. Subjects send batches with #wr_rtp_filter_notify_observers_batch; observers
+ *  without wr_rtp_filter_t#notify_batch receive the same packets one by one as NEW_PACKET events, so filters
+ *  may be batch-aware or not independently of each other. Packets of the batch are owned by the subject and 
+ *  may be reused as soon as notify_batch returns.
+ *
  *  @{
  */
 
@@ -169,6 +246,23 @@ typedef enum __wr_event_type {
     TRANSMISSION_END,   /**< transmission of packets is stopped, observer should execute all actions to finalize */
 } wr_event_type_t;
 
+/** Maximum number of packets which may be sent with one #wr_rtp_filter_notify_observers_batch call */
+#define WR_MAX_BATCH_SIZE 64
+
+
+
+/**
+ * Counters of the filter, collected only if wr_rtp_filter_t#instrumented is set
+ * Time is measured with monotonic clock and does not include time spent in the observers of the filter.
+ */
+typedef struct __wr_rtp_filter_stats {
+    unsigned long calls;        /**< number of NEW_PACKET notifies (batch notify is one call) */
+    unsigned long packets_in;   /**< number of packets received */
+    unsigned long packets_out;  /**< number of packets sent to observers */
+    uint64_t total_ns;          /**< time spent in the filter */
+    uint64_t max_ns;            /**< maximal time spent in one call */
+} wr_rtp_filter_stats_t;
+
 
 
 /**
@@ -193,9 +287,18 @@ typedef struct __wr_rtp_filter {
     /** observer interface */
     wr_errorcode_t (*notify)(struct __wr_rtp_filter * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
 
+    /** observer interface, optional: receive batch of new packets at once */
+    wr_errorcode_t (*notify_batch)(struct __wr_rtp_filter * filter, wr_rtp_packet_t ** packets, int count);
+
     /** internal state of the filter */
     void * state;
 
+    /** collect counters of the filter */
+    int instrumented;
+
+    /** counters of the filter */
+    wr_rtp_filter_stats_t stats;
+
 } wr_rtp_filter_t;
 
 
@@ -209,6 +312,19 @@ void wr_rtp_filter_create(wr_rtp_filter_t * filter, char *name,
         wr_errorcode_t (*notify)(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet) 
     );
 
+/**
+ * Set batch notify callback of the filter
+ * @param notify_batch invoked with all packets of the batch instead of NEW_PACKET events
+ */
+void wr_rtp_filter_set_notify_batch(wr_rtp_filter_t * filter, 
+        wr_errorcode_t (*notify_batch)(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+    );
+
+/**
+ * Start collecting counters of the filter (see #wr_rtp_filter_stats_t)
+ */
+void wr_rtp_filter_enable_stats(wr_rtp_filter_t * filter);
+
 /**
  * Append observer to the filter
  */
@@ -219,6 +335,14 @@ void wr_rtp_filter_append_observer(wr_rtp_filter_t * filter, wr_rtp_filter_t * o
  */
 void wr_rtp_filter_notify_observers(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
 
+/**
+ * Notify all observers that batch of new RTP packets was transmitted
+ * Observers which have no wr_rtp_filter_t#notify_batch are notified with NEW_PACKET event for each packet of the
+ * batch.
+ * @param packets array of count packets, count must not exceed #WR_MAX_BATCH_SIZE
+ */
+void wr_rtp_filter_notify_observers_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+
 /**
  * Generic notify callback function (do nothing)
  * Used for example for filters which have not input subject filters (such as input wavfile filter)
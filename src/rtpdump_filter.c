@@ -43,6 +43,7 @@
 #include "rtpdump_filter.h"
 #include "options.h"
 #include "misc.h"
+#include "output_writer.h"
 
 typedef struct st_rtpdump_info
 {
@@ -55,35 +56,34 @@ typedef struct st_rtpdump_info
  * Structure to store internal state of the rtpdump output filter
  */
 typedef struct __wr_rtpdump_filter_state {
-    FILE * file;
-    struct timeval start_timestamp;
+    wr_output_writer_t writer;
+    wr_time_t start_timestamp;
 } wr_rtpdump_filter_state_t;
 
 static wr_errorcode_t __write_rtpdump_header(wr_rtpdump_filter_state_t *state)
 {
+    char header[256];
     struct timeval timestamp;
     struct in_addr ip_src;
     uint16_t port, padding = 0;
 
-    size_t len = fprintf(state->file, "#!rtpplay1.0 %s/%u\n",
-                         iniparser_getstring(wr_options.output_options, "global:dst_ip", "127.0.0.2"),
-                         iniparser_getnonnegativeint(wr_options.output_options, "global:dst_port", 8002));
-    if (len < 1)
+    int len = snprintf(header, sizeof(header) - sizeof(timestamp) - 8, "#!rtpplay1.0 %s/%u\n",
+                       iniparser_getstring(wr_options.output_options, "global:dst_ip", "127.0.0.2"),
+                       iniparser_getnonnegativeint(wr_options.output_options, "global:dst_port", 8002));
+    if (len < 1 || len >= (int)(sizeof(header) - sizeof(timestamp) - 8))
         return WR_FATAL;
     ip_src.s_addr = inet_addr(iniparser_getstring(wr_options.output_options, "global:src_ip", "127.0.0.1"));
     port = htons((short)iniparser_getnonnegativeint(wr_options.output_options, "global:src_port", 8001));
-    timestamp.tv_sec = htonl(state->start_timestamp.tv_sec);
-    timestamp.tv_usec = htonl(state->start_timestamp.tv_usec);
+    wr_time_to_timeval(state->start_timestamp, &timestamp);
+    timestamp.tv_sec = htonl(timestamp.tv_sec);
+    timestamp.tv_usec = htonl(timestamp.tv_usec);
 
-    if (fwrite(&timestamp, sizeof(timestamp), 1, state->file) == 0)
-        return WR_FATAL;
-    if (fwrite(&ip_src.s_addr, 4, 1, state->file) == 0)
-        return WR_FATAL;
-    if (fwrite(&port, 2, 1, state->file) == 0)
-        return WR_FATAL;
-    if (fwrite(&padding, 2, 1, state->file) == 0)
-        return WR_FATAL;
-    return WR_OK;
+    /* the text line is followed by start time, source address, port and padding */
+    memcpy(header + len, &timestamp, sizeof(timestamp));   len += sizeof(timestamp);
+    memcpy(header + len, &ip_src.s_addr, 4);               len += 4;
+    memcpy(header + len, &port, 2);                        len += 2;
+    memcpy(header + len, &padding, 2);                     len += 2;
+    return wr_output_writer_write(&state->writer, header, len);
 }
 
 wr_errorcode_t wr_rtpdump_filter_notify(wr_rtp_filter_t *filter, wr_event_type_t event, wr_rtp_packet_t *packet)
@@ -92,19 +92,18 @@ wr_errorcode_t wr_rtpdump_filter_notify(wr_rtp_filter_t *filter, wr_event_type_t
     {
     case TRANSMISSION_START:
     {
+        wr_errorcode_t retval;
         wr_rtpdump_filter_state_t *state = calloc(1, sizeof(wr_rtpdump_filter_state_t));
-        state->file = fopen(wr_options.output_filename, "wb");
-        if (!state->file)
+        if ((retval = wr_output_writer_open(&state->writer, iniparser_getstring(wr_options.output_options, "rtpdump:filename", wr_options.output_filename))) != WR_OK)
         {
             free(state);
             filter->state = NULL;
-            wr_set_error("Cannot open output file");
-            return WR_FATAL;
+            return retval;
         }
-        timeval_copy(&state->start_timestamp, &packet->lowlevel_timestamp);
+        state->start_timestamp = packet->lowlevel_timestamp;
         if (__write_rtpdump_header(state) != WR_OK)
         {
-            fclose(state->file);
+            wr_output_writer_close(&state->writer);
             free(state);
             wr_set_error("Cannot write rtpdump header to the file");
             return WR_FATAL;
@@ -118,58 +117,33 @@ wr_errorcode_t wr_rtpdump_filter_notify(wr_rtp_filter_t *filter, wr_event_type_t
         wr_errorcode_t retval;
         rtpdump_info_t rtpdump_packet;
         wr_rtp_header_t rtp_header;
-        struct timeval timediff;
         wr_rtpdump_filter_state_t *state = (wr_rtpdump_filter_state_t *)filter->state;
-        rtpdump_packet.plen = sizeof(rtp_header);
-        list_iterator_start(&(packet->data_frames));
-        while (list_iterator_hasnext(&(packet->data_frames)))
-        {
-            wr_data_frame_t *current_data = list_iterator_next(&(packet->data_frames));
-            rtpdump_packet.plen += current_data->size;
-        }
-        list_iterator_stop(&(packet->data_frames));
+        rtpdump_packet.plen = sizeof(rtp_header) + packet->payload_size;
         wr_rtp_header_init(&rtp_header, packet);
         rtpdump_packet.length = htons(rtpdump_packet.plen + sizeof(rtpdump_packet));
         rtpdump_packet.plen = htons(rtpdump_packet.plen);
-        timersub(&packet->lowlevel_timestamp, &state->start_timestamp, &timediff);
-        rtpdump_packet.rec_time = htonl(timediff.tv_sec * 1000 + timediff.tv_usec / 1000);
+        rtpdump_packet.rec_time = htonl((uint32_t)((packet->lowlevel_timestamp - state->start_timestamp) / WR_NSEC_PER_MSEC));
         {
-            int retval;
+            /* headers are put into the headroom of the packet, so the record is written at once */
+            uint8_t *record = wr_rtp_packet_payload(packet) - sizeof(rtpdump_packet) - sizeof(rtp_header);
             if (!filter->state)
             {
                 wr_set_error("internal state of the output filter was not initialized");
                 return WR_FATAL;
             }
-            retval = fwrite(&rtpdump_packet, sizeof(rtpdump_packet), 1, state->file);
-            if (retval != 1)
-            {
-                wr_set_error("cannot write packet header");
-                return WR_FATAL;
-            }
-            retval = fwrite(&rtp_header, sizeof(rtp_header), 1, state->file);
-            if (retval != 1)
-            {
-                wr_set_error("cannot write RTP header");
-                return WR_FATAL;
-            }
-            list_iterator_start(&(packet->data_frames));
-            while (list_iterator_hasnext(&(packet->data_frames)))
-            {
-                wr_data_frame_t *current_data = list_iterator_next(&(packet->data_frames));
-                fwrite(current_data->data, current_data->size, 1, state->file);
-            }
-            list_iterator_stop(&(packet->data_frames));
+            memcpy(record, &rtpdump_packet, sizeof(rtpdump_packet));
+            memcpy(record + sizeof(rtpdump_packet), &rtp_header, sizeof(rtp_header));
+            return wr_output_writer_write(&state->writer, record, sizeof(rtpdump_packet) + sizeof(rtp_header) + packet->payload_size);
         }
     }
-        return WR_OK;
 
     case TRANSMISSION_END:
         if (filter->state)
         {
             wr_rtpdump_filter_state_t *state = (wr_rtpdump_filter_state_t *)filter->state;
-            fclose(state->file);
+            wr_errorcode_t retval = wr_output_writer_close(&state->writer);
             free(filter->state);
-            return WR_OK;
+            return retval;
         }
         else
         {
@@ -39,6 +39,7 @@
 
 /** @defgroup rtpdump_filter rtpdump output filter method definitions
  * rtpdump filter which convert rtp packets to rtpdump format and store them into file
+ * Output file is given with "-t" option, it may be redefined with "rtpdump:filename" option
  *  @{
  */
 
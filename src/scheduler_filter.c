@@ -0,0 +1,353 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "misc.h"
+#include "scheduler_filter.h"
+
+/** Number of nodes allocated at once */
+#define WR_SCHEDULER_CHUNK 256
+
+#define __slot_of(tick, level) ((int)(((tick) >> ((level) * WR_SCHEDULER_LEVEL_BITS)) & (WR_SCHEDULER_SLOTS - 1)))
+
+/** Block of nodes, blocks are freed on TRANSMISSION_END */
+typedef struct __wr_scheduler_chunk {
+    struct __wr_scheduler_chunk * next;
+    wr_scheduler_node_t nodes[WR_SCHEDULER_CHUNK];
+} wr_scheduler_chunk_t;
+
+
+
+static wr_scheduler_node_t * __node_new(wr_scheduler_filter_state_t * state)
+{
+    wr_scheduler_node_t * node;
+    if (!state->free_nodes){
+        int i;
+        wr_scheduler_chunk_t * chunk = malloc(sizeof(*chunk));
+        if (!chunk)
+            return NULL;
+        chunk->next = state->chunks;
+        state->chunks = chunk;
+        for (i=0; i<WR_SCHEDULER_CHUNK; i++){
+            chunk->nodes[i].next = state->free_nodes;
+            state->free_nodes = &chunk->nodes[i];
+        }
+    }
+    node = state->free_nodes;
+    state->free_nodes = node->next;
+    return node;
+}
+
+
+
+/**
+ * Append node to the list keeping it ordered (packets mostly come in order, so the tail is checked first)
+ */
+static void __slot_insert(wr_scheduler_slot_t * slot, wr_scheduler_node_t * node)
+{
+    wr_scheduler_node_t ** link;
+    node->next = NULL;
+    if (!slot->head){
+        slot->head = slot->tail = node;
+        return;
+    }
+    if (slot->tail->packet.lowlevel_timestamp <= node->packet.lowlevel_timestamp){
+        slot->tail->next = node;
+        slot->tail = node;
+        return;
+    }
+    link = &slot->head;
+    while ((*link)->packet.lowlevel_timestamp <= node->packet.lowlevel_timestamp)
+        link = &(*link)->next;
+    node->next = *link;
+    *link = node;
+}
+
+
+
+/**
+ * Put node to the level where all higher bits of its tick are equal to the current tick
+ */
+static void __wheel_insert(wr_scheduler_filter_state_t * state, wr_scheduler_node_t * node)
+{
+    int level;
+    for (level=0; level<WR_SCHEDULER_LEVELS; level++){
+        int shift = (level + 1) * WR_SCHEDULER_LEVEL_BITS;
+        if ((node->tick >> shift) == (state->now >> shift)){
+            int slot = __slot_of(node->tick, level);
+            __slot_insert(&state->slots[level][slot], node);
+            state->occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+            return;
+        }
+    }
+    __slot_insert(&state->overflow, node);
+}
+
+
+
+/**
+ * Take all nodes of the slot
+ */
+static wr_scheduler_node_t * __slot_take(wr_scheduler_filter_state_t * state, int level, int slot)
+{
+    wr_scheduler_node_t * head = state->slots[level][slot].head;
+    state->slots[level][slot].head = state->slots[level][slot].tail = NULL;
+    state->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    return head;
+}
+
+
+
+/**
+ * Find the first non-empty slot with index not less than given one
+ * @return index of the slot or -1
+ */
+static int __next_occupied(const uint64_t * bitmap, int from)
+{
+    int word;
+    for (word = from / 64; word < WR_SCHEDULER_SLOTS / 64; word++){
+        uint64_t bits = bitmap[word];
+        if (word == from / 64)
+            bits &= ~(uint64_t)0 << (from % 64);
+        if (bits)
+            return word * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
+
+
+
+/**
+ * Find the earliest tick at which something has to be done: packets of the level 0 slot are due
+ * or a slot of the higher level has to be cascaded to the lower levels
+ * @return tick or UINT64_MAX if the wheel is empty
+ */
+static uint64_t __next_event(wr_scheduler_filter_state_t * state, int * event_level)
+{
+    int level;
+    for (level=0; level<WR_SCHEDULER_LEVELS; level++){
+        int shift = level * WR_SCHEDULER_LEVEL_BITS;
+        /* slots of the level 0 are due at their tick, higher slots are cascaded at their beginning */
+        int slot = __next_occupied(state->occupied[level], __slot_of(state->now, level) + (level ? 1 : 0));
+        if (slot >= 0){
+            uint64_t range = ((uint64_t)1 << (shift + WR_SCHEDULER_LEVEL_BITS)) - 1;
+            *event_level = level;
+            return (state->now & ~range) | ((uint64_t)slot << shift);
+        }
+    }
+    if (state->overflow.head){
+        uint64_t range = ((uint64_t)1 << (WR_SCHEDULER_LEVELS * WR_SCHEDULER_LEVEL_BITS)) - 1;
+        *event_level = WR_SCHEDULER_LEVELS;
+        return state->overflow.head->tick & ~range;
+    }
+    *event_level = 0;
+    return UINT64_MAX;
+}
+
+
+
+static void __flush(wr_rtp_filter_t * filter, wr_scheduler_filter_state_t * state)
+{
+    int i;
+    wr_rtp_filter_notify_observers_batch(filter, state->out, state->out_count);
+    for (i=0; i<state->out_count; i++){
+        wr_scheduler_node_t * node = state->out_nodes[i];
+        wr_rtp_packet_destroy(&node->packet);
+        node->next = state->free_nodes;
+        state->free_nodes = node;
+    }
+    state->out_count = 0;
+}
+
+
+
+static void __release(wr_rtp_filter_t * filter, wr_scheduler_filter_state_t * state, wr_scheduler_node_t * node)
+{
+    state->out[state->out_count] = &node->packet;
+    state->out_nodes[state->out_count] = node;
+    if (++state->out_count == WR_MAX_BATCH_SIZE)
+        __flush(filter, state);
+}
+
+
+
+/**
+ * Release all packets with ticks earlier than the given one
+ */
+static void __advance(wr_rtp_filter_t * filter, wr_scheduler_filter_state_t * state, uint64_t target)
+{
+    for (;;){
+        int level;
+        wr_scheduler_node_t * node;
+        uint64_t tick = __next_event(state, &level);
+        if (level ? tick > target : tick >= target){
+            /* nothing is due before the target, a slot starting at the target is cascaded first */
+            if (target != UINT64_MAX && state->now < target)
+                state->now = target;
+            return;
+        }
+        state->now = tick;
+        if (level == 0){
+            node = __slot_take(state, 0, __slot_of(tick, 0));
+            while (node){
+                wr_scheduler_node_t * next = node->next;
+                __release(filter, state, node);
+                node = next;
+            }
+        } else {
+            if (level < WR_SCHEDULER_LEVELS){
+                node = __slot_take(state, level, __slot_of(tick, level));
+            } else {
+                node = state->overflow.head;
+                state->overflow.head = state->overflow.tail = NULL;
+            }
+            while (node){
+                wr_scheduler_node_t * next = node->next;
+                __wheel_insert(state, node);
+                node = next;
+            }
+        }
+    }
+}
+
+
+
+static wr_errorcode_t __schedule(wr_rtp_filter_t * filter, wr_scheduler_filter_state_t * state, wr_rtp_packet_t * packet)
+{
+    wr_scheduler_node_t * node;
+    wr_time_t timestamp = packet->lowlevel_timestamp;
+    if (!state->started){
+        /* no later packet may be earlier than this one minus the maximum delay */
+        state->base = timestamp - state->max_delay;
+        state->latest = timestamp;
+        state->started = 1;
+    }
+    if (timestamp < state->base + (wr_time_t)state->now * state->resolution){
+        /* delayed more than max_delay, its place in the stream is already passed */
+        wr_rtp_filter_notify_observers(filter, NEW_PACKET, packet);
+        return WR_OK;
+    }
+    node = __node_new(state);
+    if (!node){
+        wr_set_error("cannot allocate memory for the scheduled packet");
+        return WR_FATAL;
+    }
+    wr_rtp_packet_share(&node->packet, packet);
+    node->tick = (uint64_t)((timestamp - state->base) / state->resolution);
+    __wheel_insert(state, node);
+    if (timestamp > state->latest)
+        state->latest = timestamp;
+    return WR_OK;
+}
+
+
+
+/**
+ * Release packets which no later packet can precede
+ */
+static void __release_due(wr_rtp_filter_t * filter, wr_scheduler_filter_state_t * state)
+{
+    wr_time_t watermark = state->latest - state->max_delay;
+    if (watermark > state->base)
+        __advance(filter, state, (uint64_t)((watermark - state->base) / state->resolution));
+    __flush(filter, state);
+}
+
+
+
+wr_errorcode_t wr_scheduler_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_scheduler_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the scheduler filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "scheduler:enabled", 1);
+            state->max_delay = iniparser_getnonnegativeint(wr_options.output_options, "scheduler:max_delay", 100000) * WR_NSEC_PER_USEC;
+            state->resolution = iniparser_getpositiveint(wr_options.output_options, "scheduler:resolution", 1) * WR_NSEC_PER_USEC;
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+        case NEW_PACKET: {
+            wr_errorcode_t retval;
+            wr_scheduler_filter_state_t * state = (wr_scheduler_filter_state_t * ) (filter->state);
+            if (!state->enabled){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            if ((retval = __schedule(filter, state, packet)) != WR_OK)
+                return retval;
+            __release_due(filter, state);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_scheduler_filter_state_t * state = (wr_scheduler_filter_state_t * ) (filter->state);
+            __advance(filter, state, UINT64_MAX);
+            __flush(filter, state);
+            while (state->chunks){
+                wr_scheduler_chunk_t * chunk = state->chunks;
+                state->chunks = chunk->next;
+                free(chunk);
+            }
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_scheduler_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_scheduler_filter_state_t * state = (wr_scheduler_filter_state_t * ) (filter->state);
+    int i;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    for (i=0; i<count; i++){
+        wr_errorcode_t retval = __schedule(filter, state, packets[i]);
+        if (retval != WR_OK)
+            return retval;
+    }
+    __release_due(filter, state);
+    return WR_OK;
+}
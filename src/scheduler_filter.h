@@ -0,0 +1,110 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef SCHEDULER_FILTER_H
+#define SCHEDULER_FILTER_H
+#include "rtpapi.h"
+
+/** @defgroup scheduler_filter scheduler filter
+ * This filter releases packets in the order of their lowlevel timestamps. Unlike the sort filter
+ * it is driven by time: a packet is released when the latest timestamp seen by the filter
+ * is later than the timestamp of the packet by more than the maximum delay, so no later packet
+ * can precede it. Packets wait in a hierarchical timing wheel, so the cost per packet is O(1)
+ * amortized and memory depends only on the number of packets in the delay window.
+ * It has to be used after delay filters.
+ * It uses section [scheduler] of the configuration file "output.ini"
+ * There is two used options
+ *
+ *    max_delay = integer
+ *    resolution = integer
+ *
+ * Maximal delay of the preceding filters and tick of the wheel are integer values in microseconds.
+ * Packets which are delayed more than max_delay are released at once (out of order).
+ *  @{
+ */
+
+/** Number of levels of the timing wheel */
+#define WR_SCHEDULER_LEVELS 4
+/** Number of bits of the tick used by one level */
+#define WR_SCHEDULER_LEVEL_BITS 8
+/** Number of slots in one level */
+#define WR_SCHEDULER_SLOTS (1 << WR_SCHEDULER_LEVEL_BITS)
+
+/** Packet waiting in the wheel */
+typedef struct __wr_scheduler_node {
+    wr_rtp_packet_t packet;             /**< reference to the payload of the packet */
+    uint64_t tick;                      /**< tick of the packet timestamp */
+    struct __wr_scheduler_node * next;
+} wr_scheduler_node_t;
+
+/** List of packets, ordered by timestamp */
+typedef struct __wr_scheduler_slot {
+    wr_scheduler_node_t * head;
+    wr_scheduler_node_t * tail;
+} wr_scheduler_slot_t;
+
+/** 
+ * Structure to store internal state of the scheduler filter
+ */
+typedef struct __wr_scheduler_filter_state {
+    int enabled;
+    wr_time_t max_delay;                /**< maximum delay (ns) */
+    wr_time_t resolution;               /**< duration of one tick (ns) */
+    wr_time_t base;                     /**< timestamp of the tick 0 */
+    wr_time_t latest;                   /**< latest timestamp seen by the filter */
+    int started;                        /**< base is set */
+    uint64_t now;                       /**< current tick, all earlier packets are released */
+    wr_scheduler_slot_t slots[WR_SCHEDULER_LEVELS][WR_SCHEDULER_SLOTS];
+    uint64_t occupied[WR_SCHEDULER_LEVELS][WR_SCHEDULER_SLOTS / 64]; /**< bitmaps of non-empty slots */
+    wr_scheduler_slot_t overflow;       /**< packets which are too far from the current tick */
+    wr_scheduler_node_t * free_nodes;   /**< recycled nodes */
+    void * chunks;                      /**< allocated blocks of nodes */
+    wr_rtp_packet_t * out[WR_MAX_BATCH_SIZE]; /**< released packets which are not sent yet */
+    wr_scheduler_node_t * out_nodes[WR_MAX_BATCH_SIZE];
+    int out_count;
+} wr_scheduler_filter_state_t;
+
+/**
+ * Put packet into the wheel and release packets which are due.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_scheduler_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_scheduler_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_scheduler_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 3000
+#define START_TIME (1200000000LL * WR_NSEC_PER_SEC)
+#define MINUTE (60LL * WR_NSEC_PER_SEC)
+
+
+/**
+ * Check that the sink got each packet once and in order of timestamps
+ */
+static int check_sorted(wr_rtp_filter_t * sink, size_t count)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    static char seen[PACKETS];
+    size_t i;
+    ASSERT(state->finished, "transmission is not finished");
+    ASSERT(state->count == count, "%u packets of %u are received", (unsigned)state->count, (unsigned)count);
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < state->count; i++){
+        wr_test_record_t * cur = &state->records[i];
+        ASSERT(!seen[cur->sequence_number], "packet %d is received twice", cur->sequence_number);
+        seen[cur->sequence_number] = 1;
+        ASSERT(i == 0 || state->records[i - 1].lowlevel_timestamp <= cur->lowlevel_timestamp,
+                "packet %d is sent before packet %d", state->records[i - 1].sequence_number, cur->sequence_number);
+    }
+    return 0;
+}
+
+
+static long long random_below(long long limit)
+{
+    return (((long long)rand() << 31) ^ rand()) % limit;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t scheduler, sink;
+    static wr_rtp_packet_t packets[PACKETS];
+    int batch_sizes[] = {1, 5, WR_MAX_BATCH_SIZE};
+    size_t i, b;
+
+    CHECK( wr_test_options_init("scheduler_test") );
+    CHECK( wr_test_set_option("scheduler:enabled=true") );
+    CHECK( wr_test_set_option("scheduler:resolution=1") );
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&scheduler, "scheduler", &wr_scheduler_filter_notify, &wr_scheduler_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++)
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, 0) );
+    srand(1);
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* delays of all levels of the wheel (tick is 1 us, levels are 256 us, 65 ms, 16 s and 71 min long) */
+        long long scales[] = {200 * WR_NSEC_PER_USEC, 50 * WR_NSEC_PER_MSEC, 10 * WR_NSEC_PER_SEC, 20 * MINUTE};
+        CHECK( wr_test_set_option("scheduler:max_delay=1500000000") );
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = START_TIME + i * 20 * WR_NSEC_PER_MSEC + random_below(scales[i % 4]);
+        CHECK( wr_test_transmit(&scheduler, packets, PACKETS, batch_sizes[b]) );
+        if (check_sorted(&sink, PACKETS))
+            return 1;
+
+        /* all packets after the first one are further than the last level (2^32 ticks), they wait in the overflow list */
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = START_TIME + (i ? 72 * MINUTE + i * 2 * WR_NSEC_PER_MSEC + random_below(20 * MINUTE) : 0);
+        CHECK( wr_test_transmit(&scheduler, packets, PACKETS, batch_sizes[b]) );
+        if (check_sorted(&sink, PACKETS))
+            return 1;
+    }
+
+    /* packets delayed more than max_delay are sent at once (in a batch they are sorted with the rest of the batch) */
+    CHECK( wr_test_set_option("scheduler:max_delay=1000") );
+    {
+        wr_time_t timestamps[] = {0, 10, 20, 5, 30, 30, 29, 100};
+        int order[] = {0, 1, 3, 2, 6, 4, 5, 7};
+        size_t count = sizeof(order) / sizeof(order[0]);
+        wr_test_sink_state_t * state = wr_test_sink_state(&sink);
+        for (i = 0; i < count; i++)
+            packets[i].lowlevel_timestamp = START_TIME + timestamps[i] * WR_NSEC_PER_MSEC;
+        CHECK( wr_test_transmit(&scheduler, packets, count, 1) );
+        ASSERT(state->count == count, "%u packets of %u are received", (unsigned)state->count, (unsigned)count);
+        for (i = 0; i < count; i++)
+            ASSERT(state->records[i].sequence_number == order[i], "packet %d is sent instead of %d",
+                    state->records[i].sequence_number, order[i]);
+    }
+
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -112,33 +112,28 @@ wr_errorcode_t wr_sipp_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
             return WR_OK;
         }
         case NEW_PACKET: {
-            double rand;
+            int i;
             wr_sipp_filter_state_t * state = (wr_sipp_filter_state_t * ) (filter->state);
             if (!state->enabled){
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            if (!timerisset(&state->first_timestamp)){
-                memcpy(&state->first_timestamp, &packet->lowlevel_timestamp, sizeof(struct timeval));
+            if (!state->first_timestamp){
+                state->first_timestamp = packet->lowlevel_timestamp;
             }
-            memcpy(&state->last_timestamp, &packet->lowlevel_timestamp, sizeof(struct timeval));
-            list_iterator_start(&packet->data_frames);
+            state->last_timestamp = packet->lowlevel_timestamp;
             state->last_duration = 0;
-            while (list_iterator_hasnext(&packet->data_frames)) {
-                wr_data_frame_t * data = (wr_data_frame_t*)list_iterator_next(&packet->data_frames);
-                state->last_duration += data->length_in_ms;
+            for (i=0; i<packet->frames_count; i++) {
+                state->last_duration += packet->data_frames[i].length_in_ms;
             }
-            list_iterator_stop(&packet->data_frames);
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
         case TRANSMISSION_END: {
             wr_sipp_filter_state_t * state = (wr_sipp_filter_state_t * ) (filter->state);
             if (state->enabled){
-                struct timeval diff;
                 int duration = state->last_duration;
-                timersub(&state->last_timestamp, &state->first_timestamp, &diff);
-                duration += (diff.tv_sec * 1000 + diff.tv_usec / 1000);
+                duration += (int)((state->last_timestamp - state->first_timestamp) / WR_NSEC_PER_MSEC);
                 __print_sipp_scenario(duration);
             }
             free(state);
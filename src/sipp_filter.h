@@ -50,8 +50,8 @@
  */
 typedef struct __wr_sipp_filter_state {
     int enabled;
-    struct timeval first_timestamp; /**< timestamp of the firt packet */
-    struct timeval last_timestamp;  /**< timestamp of the last packet */
+    wr_time_t first_timestamp;      /**< timestamp of the firt packet */
+    wr_time_t last_timestamp;       /**< timestamp of the last packet */
     int last_duration;              /**< duration (in ms.) of the last packet */
 } wr_sipp_filter_state_t;
 
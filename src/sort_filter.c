@@ -37,11 +37,73 @@
 
 
 
-int wr_rtp_timestamp_comparator(const void *a, const void *b)
+static int __entry_less(const wr_sort_entry_t * a, const wr_sort_entry_t * b)
 {
-    wr_rtp_packet_t * pa = (wr_rtp_packet_t *)a;
-    wr_rtp_packet_t * pb = (wr_rtp_packet_t *)b;
-    return timercmp(&pa->lowlevel_timestamp, &pb->lowlevel_timestamp, >);
+    if (a->timestamp != b->timestamp)
+        return a->timestamp < b->timestamp;
+    return a->order < b->order;
+}
+
+
+
+/**
+ * Put a reference to the packet into a free slot and add it to the heap (O(log n))
+ */
+static void __heap_push(wr_sort_filter_state_t * state, wr_rtp_packet_t * packet)
+{
+    wr_sort_entry_t entry;
+    size_t i = state->heap_size++;
+
+    entry.packet = state->free_slots[--state->free_count];
+    wr_rtp_packet_share(entry.packet, packet);
+    entry.timestamp = packet->lowlevel_timestamp;
+    entry.order = state->order++;
+    while (i > 0){
+        size_t parent = (i - 1) / 2;
+        if (!__entry_less(&entry, &state->heap[parent]))
+            break;
+        state->heap[i] = state->heap[parent];
+        i = parent;
+    }
+    state->heap[i] = entry;
+}
+
+
+
+/**
+ * Remove the earliest packet from the heap (O(log n)).
+ * Slot of the packet is owned by the caller until it is released with #__release_slot
+ */
+static wr_rtp_packet_t * __heap_pop(wr_sort_filter_state_t * state)
+{
+    wr_rtp_packet_t * packet = state->heap[0].packet;
+    wr_sort_entry_t last = state->heap[--state->heap_size];
+    size_t i = 0;
+    for (;;){
+        size_t child = 2 * i + 1;
+        if (child >= state->heap_size)
+            break;
+        if (child + 1 < state->heap_size && __entry_less(&state->heap[child + 1], &state->heap[child]))
+            child++;
+        if (!__entry_less(&state->heap[child], &last))
+            break;
+        state->heap[i] = state->heap[child];
+        i = child;
+    }
+    if (state->heap_size)
+        state->heap[i] = last;
+    return packet;
+}
+
+
+
+/**
+ * Drop the reference to the payload and return slot to the free stack
+ */
+static void __release_slot(wr_sort_filter_state_t * state, wr_rtp_packet_t * packet)
+{
+    wr_rtp_packet_destroy(packet);
+    state->free_slots[state->free_count++] = packet;
 }
 
 
@@ -51,11 +113,26 @@ wr_errorcode_t wr_sort_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
     switch(event){
 
         case TRANSMISSION_START:  {
+            size_t i;
             wr_sort_filter_state_t * state = calloc(1, sizeof(*state));
             state->enabled = iniparser_getboolean(wr_options.output_options, "sort:enabled", 1);
             state->buffer_size = iniparser_getpositiveint(wr_options.output_options, "sort:buffer_size", 1);
-            list_init(&state->buffer);
-            list_attributes_comparator(&state->buffer, &wr_rtp_timestamp_comparator);
+            state->capacity = state->buffer_size + WR_MAX_BATCH_SIZE;
+            state->slots = calloc(state->capacity, sizeof(*state->slots));
+            state->free_slots = calloc(state->capacity, sizeof(*state->free_slots));
+            state->heap = calloc(state->capacity, sizeof(*state->heap));
+            if (!state->slots || !state->free_slots || !state->heap){
+                free(state->slots);
+                free(state->free_slots);
+                free(state->heap);
+                free(state);
+                filter->state = NULL;
+                wr_set_error("cannot allocate buffer of the sort filter");
+                return WR_FATAL;
+            }
+            for (i=0; i<state->capacity; i++)
+                state->free_slots[i] = &state->slots[i];
+            state->free_count = state->capacity;
             filter->state = (void*)state;
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
@@ -66,33 +143,51 @@ wr_errorcode_t wr_sort_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t e
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            wr_rtp_packet_t * new_packet = calloc(1, sizeof(*new_packet));
-            wr_rtp_packet_copy_with_data(new_packet, packet);
-            list_append(&state->buffer, (void*)new_packet);
-            if (list_size(&state->buffer) > state->buffer_size){
-                wr_rtp_packet_t * first_packet;
-                list_sort(&state->buffer, -1); 
-                first_packet = list_extract_at(&state->buffer, 0);
+            /* buffered packets hold a reference to the payload, it is not copied */
+            __heap_push(state, packet);
+            if (state->heap_size > state->buffer_size){
+                wr_rtp_packet_t * first_packet = __heap_pop(state);
                 wr_rtp_filter_notify_observers(filter, event, first_packet);
-                //wr_rtp_packet_destroy(first_packet);
-                //free(first_packet);
+                __release_slot(state, first_packet);
             }
             return WR_OK;
         }
         case TRANSMISSION_END: {
             wr_sort_filter_state_t * state = (wr_sort_filter_state_t * ) (filter->state);
-            list_sort(&state->buffer, -1); 
-            while(list_size(&state->buffer)){
-                wr_rtp_packet_t * packet;
-                packet = list_extract_at(&state->buffer, 0);
-                wr_rtp_filter_notify_observers(filter, NEW_PACKET, packet);
-                wr_rtp_packet_destroy(packet);
-                free(packet);
+            while(state->heap_size){
+                wr_rtp_packet_t * first_packet = __heap_pop(state);
+                wr_rtp_filter_notify_observers(filter, NEW_PACKET, first_packet);
+                __release_slot(state, first_packet);
             }
-            list_destroy(&state->buffer);
+            free(state->slots);
+            free(state->free_slots);
+            free(state->heap);
             free(state);
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_sort_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_sort_filter_state_t * state = (wr_sort_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t * sorted[count];
+    int i, sorted_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    /* one packet is pushed and one is popped as in #wr_sort_filter_notify, so the output does not depend on the batch size */
+    for (i=0; i<count; i++){
+        __heap_push(state, packets[i]);
+        if (state->heap_size > state->buffer_size)
+            sorted[sorted_count++] = __heap_pop(state);
+    }
+    wr_rtp_filter_notify_observers_batch(filter, sorted, sorted_count);
+    for (i=0; i<sorted_count; i++)
+        __release_slot(state, sorted[i]);
+    return WR_OK;
+}
@@ -47,13 +47,29 @@
  */
 
 
+/**
+ * Entry of the reorder heap
+ */
+typedef struct __wr_sort_entry {
+    wr_time_t timestamp;        /**< key of the heap (lowlevel timestamp of the packet) */
+    uint64_t order;             /**< arrival number, packets with equal timestamps keep their order */
+    wr_rtp_packet_t * packet;   /**< buffered packet (one of the preallocated slots) */
+} wr_sort_entry_t;
+
 /** 
- * Structure to store  internal state of the pcap output filter
+ * Structure to store  internal state of the sort filter
+ * All memory is allocated on TRANSMISSION_START, buffered packets are kept in a binary min-heap
  */
 typedef struct __wr_sort_filter_state {
     int enabled;
     size_t buffer_size;
-    list_t buffer;
+    size_t capacity;            /**< buffer_size plus one batch */
+    wr_rtp_packet_t * slots;    /**< preallocated packets which hold buffered payloads */
+    wr_rtp_packet_t ** free_slots; /**< stack of unused slots */
+    size_t free_count;
+    wr_sort_entry_t * heap;     /**< binary min-heap of buffered packets */
+    size_t heap_size;
+    uint64_t order;             /**< arrival number of the next packet */
 } wr_sort_filter_state_t;
 
 /**
@@ -61,6 +77,11 @@ typedef struct __wr_sort_filter_state {
  * This method is invoked when filter is notified.
  */
 wr_errorcode_t wr_sort_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_sort_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_sort_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
 /** @} */
 
 #endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sort_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 1000
+
+
+/**
+ * Check that the sink got all packets ordered by timestamps, packets with equal timestamps in order of arrival
+ */
+static int check_sorted(wr_rtp_filter_t * sink, size_t count)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    size_t i;
+    ASSERT(state->finished, "transmission is not finished");
+    ASSERT(state->count == count, "%u packets of %u are received", (unsigned)state->count, (unsigned)count);
+    for (i = 1; i < state->count; i++){
+        wr_test_record_t * prev = &state->records[i - 1], * cur = &state->records[i];
+        ASSERT(prev->lowlevel_timestamp <= cur->lowlevel_timestamp,
+                "packet %d is sent before packet %d", prev->sequence_number, cur->sequence_number);
+        ASSERT(prev->lowlevel_timestamp < cur->lowlevel_timestamp || prev->sequence_number < cur->sequence_number,
+                "packets %d and %d with equal timestamps are swapped", prev->sequence_number, cur->sequence_number);
+    }
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t sort, sink;
+    static wr_rtp_packet_t packets[PACKETS];
+    int batch_sizes[] = {1, 7, WR_MAX_BATCH_SIZE};
+    size_t i, b;
+
+    CHECK( wr_test_options_init("sort_test") );
+    CHECK( wr_test_set_option("sort:enabled=true") );
+    wr_test_sink_create(&sink, 2 * PACKETS);
+    wr_test_filter_create(&sort, "sort", &wr_sort_filter_notify, &wr_sort_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++)
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, 0) );
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* descending timestamps, three packets with each timestamp: the whole stream is buffered */
+        CHECK( wr_test_set_option("sort:buffer_size=1000") );
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = (PACKETS - i) / 3 * WR_NSEC_PER_MSEC;
+        CHECK( wr_test_transmit(&sort, packets, PACKETS, batch_sizes[b]) );
+        if (check_sorted(&sink, PACKETS))
+            return 1;
+
+        /* equal timestamps only */
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = WR_NSEC_PER_SEC;
+        CHECK( wr_test_transmit(&sort, packets, PACKETS, batch_sizes[b]) );
+        if (check_sorted(&sink, PACKETS))
+            return 1;
+
+        /* packets are late by at most buffer_size positions, with ties */
+        CHECK( wr_test_set_option("sort:buffer_size=8") );
+        srand(b);
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = (i / 2) * WR_NSEC_PER_MSEC;
+        for (i = 0; i + 8 < PACKETS; i++){
+            size_t j = i + rand() % 8;
+            wr_time_t t = packets[i].lowlevel_timestamp;
+            packets[i].lowlevel_timestamp = packets[j].lowlevel_timestamp;
+            packets[j].lowlevel_timestamp = t;
+            i = j;
+        }
+        CHECK( wr_test_transmit(&sort, packets, PACKETS, batch_sizes[b]) );
+        if (check_sorted(&sink, PACKETS))
+            return 1;
+    }
+
+    /* the reorder window is buffer_size packets for any batch size: output of batches is the same as of single packets */
+    {
+        static int expected[PACKETS];
+        char * buffer_sizes[] = {"sort:buffer_size=1", "sort:buffer_size=8"};
+        size_t k;
+        srand(7);
+        for (i = 0; i < PACKETS; i++)
+            packets[i].lowlevel_timestamp = (rand() % PACKETS) * WR_NSEC_PER_MSEC;
+        for (k = 0; k < sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); k++){
+            CHECK( wr_test_set_option(buffer_sizes[k]) );
+            CHECK( wr_test_transmit(&sort, packets, PACKETS, 1) );
+            ASSERT(wr_test_sink_state(&sink)->count == PACKETS, "%u packets are received", (unsigned)wr_test_sink_state(&sink)->count);
+            for (i = 0; i < PACKETS; i++)
+                expected[i] = wr_test_sink_state(&sink)->records[i].sequence_number;
+            for (b = 1; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+                CHECK( wr_test_transmit(&sort, packets, PACKETS, batch_sizes[b]) );
+                ASSERT(wr_test_sink_state(&sink)->count == PACKETS, "%u packets are received", (unsigned)wr_test_sink_state(&sink)->count);
+                for (i = 0; i < PACKETS; i++)
+                    ASSERT(wr_test_sink_state(&sink)->records[i].sequence_number == expected[i],
+                            "%s, batch of %d: packet %d is sent at position %u instead of packet %d", buffer_sizes[k], batch_sizes[b],
+                            wr_test_sink_state(&sink)->records[i].sequence_number, (unsigned)i, expected[i]);
+            }
+        }
+        /* the example of three packets in the reverse order with buffer_size = 1 */
+        for (i = 0; i < 3; i++)
+            packets[i].lowlevel_timestamp = (3 - i) * WR_NSEC_PER_MSEC;
+        CHECK( wr_test_set_option("sort:buffer_size=1") );
+        CHECK( wr_test_transmit(&sort, packets, 3, 3) );
+        ASSERT(wr_test_sink_state(&sink)->records[0].sequence_number == 1 && wr_test_sink_state(&sink)->records[1].sequence_number == 2
+                && wr_test_sink_state(&sink)->records[2].sequence_number == 0, "batch of three packets is sorted beyond the buffer");
+    }
+
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_sink.h"
+
+char wr_error[2048];
+
+
+
+wr_errorcode_t wr_test_options_init(char * name)
+{
+    char * av[] = {
+        name, "--codec-list", "PCMU", "--to-file", "dontcare.pcap", "--from-file", "dontcare.wav"
+    };
+    return get_options(7, av, "../conf/wav2rtp/codecs.conf", "../conf/wav2rtp/output.conf");
+}
+
+
+
+wr_errorcode_t wr_test_set_option(const char * option)
+{
+    return define_option(option, wr_options.output_options);
+}
+
+
+
+static void __record(wr_test_sink_state_t * state, wr_rtp_packet_t * packet)
+{
+    wr_test_record_t * record;
+    if (state->count == state->capacity)
+        return;
+    record = &state->records[state->count++];
+    record->sequence_number = packet->sequence_number;
+    record->lowlevel_timestamp = packet->lowlevel_timestamp;
+    record->payload = packet->buffer ? wr_rtp_packet_payload(packet) : NULL;
+    record->payload_size = packet->payload_size;
+}
+
+
+
+static wr_errorcode_t __sink_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(filter);
+    switch(event){
+        case TRANSMISSION_START:
+            state->count = 0;
+            state->started = 1;
+            state->finished = 0;
+            break;
+        case NEW_PACKET:
+            __record(state, packet);
+            break;
+        case TRANSMISSION_END:
+            state->finished = 1;
+            break;
+    }
+    return WR_OK;
+}
+
+
+
+static wr_errorcode_t __sink_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    int i;
+    for (i=0; i<count; i++)
+        __record(wr_test_sink_state(filter), packets[i]);
+    return WR_OK;
+}
+
+
+
+void wr_test_sink_create(wr_rtp_filter_t * sink, size_t capacity)
+{
+    wr_test_sink_state_t * state = calloc(1, sizeof(*state));
+    state->records = calloc(capacity, sizeof(*state->records));
+    state->capacity = capacity;
+    wr_rtp_filter_create(sink, "test sink", &__sink_notify);
+    wr_rtp_filter_set_notify_batch(sink, &__sink_notify_batch);
+    sink->state = state;
+}
+
+
+
+void wr_test_sink_destroy(wr_rtp_filter_t * sink)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    free(state->records);
+    free(state);
+    sink->state = NULL;
+}
+
+
+
+void wr_test_filter_create(wr_rtp_filter_t * filter, char * name,
+        wr_errorcode_t (*notify)(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet),
+        wr_errorcode_t (*notify_batch)(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count),
+        wr_rtp_filter_t * sink)
+{
+    wr_rtp_filter_create(filter, name, notify);
+    if (notify_batch)
+        wr_rtp_filter_set_notify_batch(filter, notify_batch);
+    wr_rtp_filter_append_observer(filter, sink);
+}
+
+
+
+wr_errorcode_t wr_test_transmit(wr_rtp_filter_t * filter, wr_rtp_packet_t * packets, size_t count, int batch_size)
+{
+    wr_errorcode_t retval = filter->notify(filter, TRANSMISSION_START, count ? &packets[0] : NULL);
+    size_t i = 0;
+    while (i < count){
+        if (batch_size > 1 && filter->notify_batch){
+            wr_rtp_packet_t * batch[WR_MAX_BATCH_SIZE];
+            int n = 0;
+            while (i < count && n < batch_size && n < WR_MAX_BATCH_SIZE)
+                batch[n++] = &packets[i++];
+            filter->notify_batch(filter, batch, n);
+        } else {
+            filter->notify(filter, NEW_PACKET, &packets[i++]);
+        }
+    }
+    filter->notify(filter, TRANSMISSION_END, NULL);
+    return retval;
+}
+
+
+
+wr_errorcode_t wr_test_transmit_sequence(wr_rtp_filter_t * filter, int count, int batch_size)
+{
+    static wr_rtp_packet_t packets[WR_MAX_BATCH_SIZE];
+    wr_rtp_packet_t * batch[WR_MAX_BATCH_SIZE];
+    wr_errorcode_t retval;
+    int i, sequence_number = 0;
+    for (i=0; i<WR_MAX_BATCH_SIZE; i++){
+        if (!packets[i].buffer)
+            wr_rtp_packet_init(&packets[i], 0, 0, 0, 0, 0);
+        batch[i] = &packets[i];
+    }
+    if (batch_size > WR_MAX_BATCH_SIZE)
+        batch_size = WR_MAX_BATCH_SIZE;
+    retval = filter->notify(filter, TRANSMISSION_START, &packets[0]);
+    while (sequence_number < count){
+        int n = 0;
+        while (n < batch_size && sequence_number < count)
+            packets[n++].sequence_number = sequence_number++;
+        if (batch_size > 1 && filter->notify_batch)
+            filter->notify_batch(filter, batch, n);
+        else
+            filter->notify(filter, NEW_PACKET, &packets[0]);
+    }
+    filter->notify(filter, TRANSMISSION_END, NULL);
+    return retval;
+}
+
+
+
+void wr_test_sink_losses(wr_rtp_filter_t * sink, int count, double * loss_rate, double * burst_length)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    int prev = -1;
+    size_t i, bursts = 0;
+    for (i=0; i<state->count; i++){
+        if (state->records[i].sequence_number > prev + 1)
+            bursts++;
+        prev = state->records[i].sequence_number;
+    }
+    if (prev < count - 1)
+        bursts++;
+    *loss_rate = 1.0 - (double)state->count / count;
+    *burst_length = bursts ? (double)(count - state->count) / bursts : 0;
+}
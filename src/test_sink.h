@@ -0,0 +1,82 @@
+#ifndef TEST_SINK_H
+#define TEST_SINK_H
+#include "rtpapi.h"
+#include "options.h"
+
+/**
+ * Helpers of the check programs: a sink which records packets it receives
+ * and a source which sends given packets through the filter
+ */
+
+#define CHECK(f) { err=(f); if (err) {wr_print_error(); return 1;}  }
+#define ASSERT(cond, ...) { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); return 1; } }
+
+/** Packet received by the sink */
+typedef struct __wr_test_record {
+    int sequence_number;
+    wr_time_t lowlevel_timestamp;
+    const uint8_t * payload;    /**< payload of the packet (shared payloads have the same pointer) */
+    size_t payload_size;
+} wr_test_record_t;
+
+/** State of the sink, it is kept after TRANSMISSION_END */
+typedef struct __wr_test_sink_state {
+    wr_test_record_t * records;
+    size_t count;
+    size_t capacity;
+    int started;
+    int finished;
+} wr_test_sink_state_t;
+
+/**
+ * Load options from the configuration files of the source tree
+ */
+wr_errorcode_t wr_test_options_init(char * name);
+
+/**
+ * Set "section:key=value" option
+ */
+wr_errorcode_t wr_test_set_option(const char * option);
+
+/**
+ * Create the sink which records up to capacity packets
+ */
+void wr_test_sink_create(wr_rtp_filter_t * sink, size_t capacity);
+
+/**
+ * Free records of the sink
+ */
+void wr_test_sink_destroy(wr_rtp_filter_t * sink);
+
+/** records of the sink */
+#define wr_test_sink_state(sink) ((wr_test_sink_state_t *)(sink)->state)
+
+/**
+ * Create the filter and append the sink to its observers
+ */
+void wr_test_filter_create(wr_rtp_filter_t * filter, char * name,
+        wr_errorcode_t (*notify)(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet),
+        wr_errorcode_t (*notify_batch)(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count),
+        wr_rtp_filter_t * sink);
+
+/**
+ * Send the whole transmission through the filter: TRANSMISSION_START, count packets in batches
+ * of batch_size packets (batch_size 1 sends NEW_PACKET events) and TRANSMISSION_END.
+ * @return error of TRANSMISSION_START or WR_OK
+ */
+wr_errorcode_t wr_test_transmit(wr_rtp_filter_t * filter, wr_rtp_packet_t * packets, size_t count, int batch_size);
+
+/**
+ * Send the whole transmission of count packets with sequence numbers 0, 1, ... count - 1 through the filter
+ * (packets have no payload, see #wr_test_transmit)
+ */
+wr_errorcode_t wr_test_transmit_sequence(wr_rtp_filter_t * filter, int count, int batch_size);
+
+/**
+ * Measure losses of the transmission of count packets with sequence numbers 0, 1, ... count - 1
+ * @param loss_rate share of packets which are not received by the sink
+ * @param burst_length mean number of lost packets in a row
+ */
+void wr_test_sink_losses(wr_rtp_filter_t * sink, int count, double * loss_rate, double * burst_length);
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "misc.h"
+#include "prng.h"
+#include "trace_filter.h"
+
+
+
+static uint32_t __read_le32(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+
+static void __write_le32(uint8_t * p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+
+
+/**
+ * Parse one line of the CSV trace
+ * @return 1 if the line is a record, 0 if it has to be skipped
+ */
+static int __parse_record(const char * line, uint32_t * record)
+{
+    char * end;
+    double delay;
+    while (*line == ' ' || *line == '\t')
+        line++;
+    delay = strtod(line, &end);
+    if (end == line)
+        return 0;       /* empty line, comment or header */
+    while (*end == ' ' || *end == '\t')
+        end++;
+    if (*end == ',' || *end == ';'){
+        if (strtol(end + 1, NULL, 10) != 0)
+            delay = -1;
+    }
+    if (delay < 0){
+        *record = WR_TRACE_LOST;
+    } else {
+        /* rounded delay must not reach the WR_TRACE_LOST bit */
+        *record = (delay < WR_TRACE_LOST - 0.5) ? (uint32_t)(delay + 0.5) : WR_TRACE_LOST - 1;
+    }
+    return 1;
+}
+
+
+
+wr_errorcode_t wr_trace_compile(const char * csv_filename, const char * filename)
+{
+    char line[1024];
+    char tmp_filename[1024];
+    uint8_t header[WR_TRACE_HEADER_SIZE];
+    uint64_t count = 0;
+    int i, failed = 0;
+    FILE * out;
+    FILE * csv = fopen(csv_filename, "r");
+    if (!csv){
+        wr_set_error("cannot open trace file");
+        return WR_FATAL;
+    }
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+    if (!(out = fopen(tmp_filename, "wb"))){
+        fclose(csv);
+        wr_set_error("cannot create compiled trace file");
+        return WR_FATAL;
+    }
+    /* header is written again when the number of records is known */
+    memset(header, 0, sizeof(header));
+    failed |= (fwrite(header, sizeof(header), 1, out) != 1);
+    while (!failed && fgets(line, sizeof(line), csv)){
+        uint32_t record;
+        uint8_t bytes[4];
+        if (!__parse_record(line, &record))
+            continue;
+        __write_le32(bytes, record);
+        failed |= (fwrite(bytes, sizeof(bytes), 1, out) != 1);
+        count++;
+    }
+    memcpy(header, WR_TRACE_MAGIC, 8);
+    for (i=0; i<8; i++)
+        header[8 + i] = (uint8_t)(count >> (8 * i));
+    failed |= fseek(out, 0, SEEK_SET) != 0;
+    failed |= (fwrite(header, sizeof(header), 1, out) != 1);
+    failed |= (fclose(out) != 0);
+    fclose(csv);
+    if (failed || rename(tmp_filename, filename) != 0){
+        unlink(tmp_filename);
+        wr_set_error("cannot write compiled trace file");
+        return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Compile CSV trace if the compiled trace is missing or older than CSV,
+ * name of the binary trace is written to compiled
+ */
+static wr_errorcode_t __prepare(const char * filename, char * compiled, size_t size)
+{
+    char magic[8];
+    struct stat csv_st, st;
+    FILE * file = fopen(filename, "rb");
+    if (!file){
+        wr_set_error("cannot open trace file");
+        return WR_FATAL;
+    }
+    if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, WR_TRACE_MAGIC, sizeof(magic)) == 0){
+        fclose(file);
+        strncpy(compiled, filename, size - 1);
+        compiled[size - 1] = 0;
+        return WR_OK;
+    }
+    fclose(file);
+    if (iniparser_getstring(wr_options.output_options, "trace:compiled_filename", NULL)){
+        strncpy(compiled, iniparser_getstring(wr_options.output_options, "trace:compiled_filename", NULL), size - 1);
+        compiled[size - 1] = 0;
+    } else {
+        snprintf(compiled, size, "%s.bin", filename);
+    }
+    if (stat(filename, &csv_st) == 0 && stat(compiled, &st) == 0 && st.st_mtime >= csv_st.st_mtime)
+        return WR_OK;
+    return wr_trace_compile(filename, compiled);
+}
+
+
+
+/**
+ * Map the binary trace into memory
+ */
+static wr_errorcode_t __map(wr_trace_filter_state_t * state, const char * filename)
+{
+    struct stat st;
+    uint64_t count = 0;
+    int i;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        wr_set_error("cannot open compiled trace file");
+        return WR_FATAL;
+    }
+    if (fstat(fd, &st) || st.st_size < WR_TRACE_HEADER_SIZE){
+        close(fd);
+        wr_set_error("compiled trace file is too short");
+        return WR_FATAL;
+    }
+    state->length = st.st_size;
+#ifndef _WIN32
+    state->base = mmap(NULL, state->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (state->base == MAP_FAILED)
+        state->base = NULL;
+#else
+    if ((state->base = malloc(state->length)) && read(fd, state->base, state->length) != (ssize_t)state->length){
+        free(state->base);
+        state->base = NULL;
+    }
+#endif
+    close(fd);
+    if (!state->base){
+        wr_set_error("cannot map trace file into memory");
+        return WR_FATAL;
+    }
+    if (memcmp(state->base, WR_TRACE_MAGIC, 8) != 0){
+        wr_set_error("compiled trace file has wrong format");
+        return WR_FATAL;
+    }
+    for (i=0; i<8; i++)
+        count |= (uint64_t)((uint8_t *)state->base)[8 + i] << (8 * i);
+    state->records = (const uint8_t *)state->base + WR_TRACE_HEADER_SIZE;
+    state->count = (state->length - WR_TRACE_HEADER_SIZE) / 4;
+    if (count < state->count)
+        state->count = count;
+#ifdef MADV_SEQUENTIAL
+    madvise(state->base, state->length, MADV_SEQUENTIAL);
+#endif
+    return WR_OK;
+}
+
+
+
+static void __unmap(wr_trace_filter_state_t * state)
+{
+    if (!state->base)
+        return;
+#ifndef _WIN32
+    munmap(state->base, state->length);
+#else
+    free(state->base);
+#endif
+    state->base = NULL;
+}
+
+
+
+static wr_errorcode_t __open(wr_trace_filter_state_t * state)
+{
+    char compiled[1024];
+    wr_errorcode_t retval;
+    char * filename = iniparser_getstring(wr_options.output_options, "trace:filename", NULL);
+    if (!filename || !*filename){
+        /* no trace, packets pass unchanged */
+        state->enabled = 0;
+        return WR_OK;
+    }
+    if ((retval = __prepare(filename, compiled, sizeof(compiled))) != WR_OK)
+        return retval;
+    if ((retval = __map(state, compiled)) != WR_OK)
+        return retval;
+    state->loop = iniparser_getboolean(wr_options.output_options, "trace:loop", 1);
+    if (iniparser_getboolean(wr_options.output_options, "trace:random_offset", 0)){
+        state->position = (uint64_t)(wr_prng_uniform(&state->prng) * state->count);
+    } else {
+        state->position = (uint64_t)iniparser_getnonnegativeint(wr_options.output_options, "trace:offset", 0);
+    }
+    if (state->count && state->position >= state->count)
+        state->position %= state->count;
+    return WR_OK;
+}
+
+
+
+/**
+ * Take the next record of the trace
+ * @return 0 if the trace is finished (packets pass unchanged)
+ */
+static int __next_record(wr_trace_filter_state_t * state, uint32_t * record)
+{
+    if (state->position >= state->count){
+        if (!state->loop || !state->count)
+            return 0;
+        state->position = 0;
+    }
+    *record = __read_le32(state->records + 4 * state->position++);
+    return 1;
+}
+
+
+
+wr_errorcode_t wr_trace_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet)
+{
+    switch(event){
+
+        case TRANSMISSION_START:  {
+            wr_errorcode_t retval = WR_OK;
+            wr_trace_filter_state_t * state = calloc(1, sizeof(*state));
+            if (!state){
+                wr_set_error("cannot allocate state of the trace filter");
+                return WR_FATAL;
+            }
+            state->enabled = iniparser_getboolean(wr_options.output_options, "trace:enabled", 1);
+            /* stream is taken even if it is not used, so streams of the following filters do not depend on options */
+            wr_prng_stream_init(&state->prng);
+            if (state->enabled && (retval = __open(state)) != WR_OK){
+                /* packets pass unchanged */
+                __unmap(state);
+                state->enabled = 0;
+            }
+            filter->state = (void*)state;
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return retval;
+        }
+        case NEW_PACKET: {
+            wr_trace_filter_state_t * state = (wr_trace_filter_state_t * ) (filter->state);
+            wr_rtp_packet_t new_packet;
+            uint32_t record;
+            if (!state->enabled || !__next_record(state, &record)){
+                wr_rtp_filter_notify_observers(filter, event, packet);
+                return WR_OK;
+            }
+            if (record & WR_TRACE_LOST)
+                return WR_OK;
+            wr_rtp_packet_copy(&new_packet, packet);
+            new_packet.lowlevel_timestamp += record * WR_NSEC_PER_USEC;
+            wr_rtp_filter_notify_observers(filter, event, &new_packet);
+            return WR_OK;
+        }
+        case TRANSMISSION_END: {
+            wr_trace_filter_state_t * state = (wr_trace_filter_state_t * ) (filter->state);
+            __unmap(state);
+            free(state);
+            wr_rtp_filter_notify_observers(filter, event, packet);
+            return WR_OK;
+        }
+    }  
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_trace_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_trace_filter_state_t * state = (wr_trace_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    int i, passed_count = 0;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    for (i=0; i<count; i++){
+        uint32_t record;
+        if (!__next_record(state, &record)){
+            new_packets_ptrs[passed_count++] = packets[i];
+            continue;
+        }
+        if (record & WR_TRACE_LOST)
+            continue;
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        new_packets[i].lowlevel_timestamp += record * WR_NSEC_PER_USEC;
+        new_packets_ptrs[passed_count++] = &new_packets[i];
+    }
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, passed_count);
+    return WR_OK;
+}
@@ -0,0 +1,103 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef TRACE_FILTER_H
+#define TRACE_FILTER_H
+#include <stddef.h>
+#include <stdint.h>
+#include "rtpapi.h"
+#include "prng.h"
+
+/** @defgroup trace_filter trace replay filter
+ * This filter replays delays and losses recorded on a real network: each record of the trace
+ * is applied to the next packet, the packet is either dropped or delayed by the recorded value.
+ * It uses section [trace] of the configuration file "output.ini"
+ * There is five used options
+ *
+ *    filename = string, binary trace or CSV file (if it is not set, packets pass unchanged)
+ *    compiled_filename = string, binary trace compiled from the CSV file (default is filename.bin)
+ *    loop = boolean, start again from the first record when the trace is finished (default true)
+ *    offset = integer, number of the first record (default 0)
+ *    random_offset = boolean, start from a random record (default false)
+ *
+ * Binary trace is the WR_TRACE_MAGIC followed by little-endian 64-bit number of records
+ * and 32-bit little-endian records: delay in microseconds with the WR_TRACE_LOST bit for lost packets.
+ * It is mapped into memory and read sequentially.
+ *
+ * Each line of the CSV file is one record: delay in microseconds and optional flag
+ * (non zero if the packet is lost), packet with negative delay is lost too.
+ * Empty lines, comments (#) and a header line are skipped. CSV file is compiled into the binary
+ * trace when it is used the first time or when it is newer than the compiled file.
+ *  @{
+ */
+
+/** First bytes of the binary trace */
+#define WR_TRACE_MAGIC "WRTRACE1"
+/** Size of the header of the binary trace */
+#define WR_TRACE_HEADER_SIZE 16
+/** Flag of the lost packet in the record */
+#define WR_TRACE_LOST 0x80000000u
+
+/** 
+ * Structure to store internal state of the trace filter
+ */
+typedef struct __wr_trace_filter_state {
+    int enabled;
+    int loop;
+    void * base;                        /**< mapped trace */
+    size_t length;                      /**< length of the mapping */
+    const uint8_t * records;            /**< first record */
+    uint64_t count;                     /**< number of records */
+    uint64_t position;                  /**< number of the next record */
+    wr_prng_t prng;                     /**< stream of the filter, used only for random_offset */
+} wr_trace_filter_state_t;
+
+/**
+ * Compile CSV trace into the binary trace
+ */
+wr_errorcode_t wr_trace_compile(const char * csv_filename, const char * filename);
+
+/**
+ * Delay or drop packets of the input stream according to the trace and pass result stream to its output.
+ * This method is invoked when filter is notified.
+ */
+wr_errorcode_t wr_trace_filter_notify(wr_rtp_filter_t * filter, wr_event_type_t event, wr_rtp_packet_t * packet);
+
+/**
+ * Batch version of #wr_trace_filter_notify, invoked with all packets of the batch at once
+ */
+wr_errorcode_t wr_trace_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count);
+/** @} */
+
+#endif
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <utime.h>
+#include "trace_filter.h"
+#include "test_sink.h"
+
+#define PACKETS 40
+#define CSV_FILENAME "trace_test.csv"
+#define COMPILED_FILENAME "trace_test.csv.bin"
+#define INTERVAL (20 * WR_NSEC_PER_MSEC)
+
+/* records of the CSV trace below */
+static const uint32_t trace[] = {1000, 2500, WR_TRACE_LOST, WR_TRACE_LOST, 0, WR_TRACE_LOST - 1, 8};
+static const char * trace_csv =
+    "delay,lost\n"
+    "# comment\n"
+    "\n"
+    "1000\n"
+    "2500.4, 0\n"
+    "300,1\n"
+    "-5\n"
+    "0\n"
+    "4294967295.0\n"
+    "7.6\n";
+/* the other trace which replaces the first one when CSV is changed */
+static const uint32_t trace2[] = {5, WR_TRACE_LOST};
+static const char * trace2_csv = "5\n1;1\n";
+
+
+static int write_file(const char * filename, const char * data, time_t mtime)
+{
+    struct utimbuf times;
+    FILE * file = fopen(filename, "w");
+    ASSERT(file, "cannot create %s", filename);
+    fputs(data, file);
+    fclose(file);
+    times.actime = times.modtime = mtime;
+    ASSERT(utime(filename, &times) == 0, "cannot set time of %s", filename);
+    return 0;
+}
+
+
+/**
+ * Check that packet i of the transmission got record (start + i) of the trace:
+ * lost packets are not received, the others are delayed by the record (microseconds).
+ * Packets after the end of the trace pass unchanged unless it loops.
+ */
+static int check_replay(wr_rtp_filter_t * sink, const uint32_t * records, int count, int start, int loop)
+{
+    wr_test_sink_state_t * state = wr_test_sink_state(sink);
+    size_t received = 0;
+    int i;
+    ASSERT(state->finished, "transmission is not finished");
+    for (i = 0; i < PACKETS; i++){
+        wr_time_t delay = 0;
+        if (start + i < count || loop){
+            uint32_t record = records[(start + i) % count];
+            if (record & WR_TRACE_LOST)
+                continue;
+            delay = record * WR_NSEC_PER_USEC;
+        }
+        ASSERT(received < state->count, "packet %d is lost", i);
+        ASSERT(state->records[received].sequence_number == i, "packet %d is lost", i);
+        ASSERT(state->records[received].lowlevel_timestamp == i * INTERVAL + delay, "packet %d is delayed by %lld ns instead of %lld ns",
+                i, (long long)(state->records[received].lowlevel_timestamp - i * INTERVAL), (long long)delay);
+        received++;
+    }
+    ASSERT(received == state->count, "%u packets are received instead of %u", (unsigned)state->count, (unsigned)received);
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    wr_errorcode_t err;
+    wr_rtp_filter_t filter, sink;
+    static wr_rtp_packet_t packets[PACKETS];
+    int batch_sizes[] = {1, WR_MAX_BATCH_SIZE};
+    int count = sizeof(trace) / sizeof(trace[0]);
+    time_t now = time(NULL);
+    size_t i, b;
+
+    CHECK( wr_test_options_init("trace_test") );
+    CHECK( wr_test_set_option("trace:enabled=true") );
+    CHECK( wr_test_set_option("trace:filename=" CSV_FILENAME) );
+    wr_test_sink_create(&sink, PACKETS);
+    wr_test_filter_create(&filter, "trace", &wr_trace_filter_notify, &wr_trace_filter_notify_batch, &sink);
+    for (i = 0; i < PACKETS; i++)
+        CHECK( wr_rtp_packet_init(&packets[i], 0, i, 0, 0, i * INTERVAL) );
+    unlink(COMPILED_FILENAME);
+    if (write_file(CSV_FILENAME, trace_csv, now - 100))
+        return 1;
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++){
+        /* CSV is compiled on the first use, the trace loops after its last record */
+        CHECK( wr_test_set_option("trace:loop=true") );
+        CHECK( wr_test_set_option("trace:offset=0") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        ASSERT(access(COMPILED_FILENAME, R_OK) == 0, "trace is not compiled");
+        if (check_replay(&sink, trace, count, 0, 1))
+            return 1;
+
+        /* without the loop packets pass unchanged after the end of the trace */
+        CHECK( wr_test_set_option("trace:loop=false") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        if (check_replay(&sink, trace, count, 0, 0))
+            return 1;
+
+        /* offset is taken modulo the length of the trace */
+        CHECK( wr_test_set_option("trace:loop=true") );
+        CHECK( wr_test_set_option("trace:offset=10") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        if (check_replay(&sink, trace, count, 10 % count, 1))
+            return 1;
+
+        /* random offset: the whole stream follows the trace from one of its records */
+        CHECK( wr_test_set_option("trace:offset=0") );
+        CHECK( wr_test_set_option("trace:random_offset=true") );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        {
+            int start, matched = 0;
+            for (start = 0; start < count && !matched; start++){
+                wr_test_sink_state_t * state = wr_test_sink_state(&sink);
+                size_t received = 0;
+                matched = 1;
+                for (i = 0; i < PACKETS && matched; i++){
+                    uint32_t record = trace[(start + i) % count];
+                    if (record & WR_TRACE_LOST)
+                        continue;
+                    matched = received < state->count && state->records[received].sequence_number == (int)i
+                        && state->records[received].lowlevel_timestamp == i * INTERVAL + record * WR_NSEC_PER_USEC;
+                    received++;
+                }
+                matched = matched && received == state->count;
+            }
+            ASSERT(matched, "stream does not follow the trace from any record");
+        }
+        CHECK( wr_test_set_option("trace:random_offset=false") );
+
+        /* compiled trace is used directly */
+        CHECK( wr_test_set_option("trace:filename=" COMPILED_FILENAME) );
+        CHECK( wr_test_transmit(&filter, packets, PACKETS, batch_sizes[b]) );
+        if (check_replay(&sink, trace, count, 0, 1))
+            return 1;
+        CHECK( wr_test_set_option("trace:filename=" CSV_FILENAME) );
+    }
+
+    /* compiled trace which is newer than CSV is not compiled again */
+    if (write_file(CSV_FILENAME, trace2_csv, now - 200))
+        return 1;
+    CHECK( wr_test_transmit(&filter, packets, PACKETS, 1) );
+    if (check_replay(&sink, trace, count, 0, 1))
+        return 1;
+    /* CSV which is newer than the compiled trace is compiled again */
+    if (write_file(CSV_FILENAME, trace2_csv, now + 100))
+        return 1;
+    CHECK( wr_test_transmit(&filter, packets, PACKETS, 1) );
+    if (check_replay(&sink, trace2, sizeof(trace2) / sizeof(trace2[0]), 0, 1))
+        return 1;
+
+    /* missing trace: the error is reported, packets pass unchanged */
+    CHECK( wr_test_set_option("trace:filename=trace_test_missing.csv") );
+    ASSERT(wr_test_transmit(&filter, packets, PACKETS, 1) == WR_FATAL, "missing trace is accepted");
+    ASSERT(wr_test_sink_state(&sink)->count == PACKETS, "packets are lost without the trace");
+
+    unlink(CSV_FILENAME);
+    unlink(COMPILED_FILENAME);
+    for (i = 0; i < PACKETS; i++)
+        wr_rtp_packet_destroy(&packets[i]);
+    wr_test_sink_destroy(&sink);
+    return WR_OK;
+}
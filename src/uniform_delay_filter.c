@@ -32,7 +32,6 @@
  *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  */
-#include "contrib/ranlib/ranlib.h"
 #include "misc.h"
 #include "uniform_delay_filter.h"
 
@@ -49,6 +48,7 @@ wr_errorcode_t wr_uniform_delay_filter_notify(wr_rtp_filter_t * filter, wr_event
                 state->min_delay = iniparser_getnonnegativeint(wr_options.output_options, "uniform_delay:min_delay", 0);
                 state->max_delay = iniparser_getnonnegativeint(wr_options.output_options, "uniform_delay:max_delay", 0);
             }
+            wr_prng_stream_init(&state->prng);
             filter->state = (void*)state;
             wr_rtp_filter_notify_observers(filter, event, packet);
             return WR_OK;
@@ -61,9 +61,9 @@ wr_errorcode_t wr_uniform_delay_filter_notify(wr_rtp_filter_t * filter, wr_event
                 wr_rtp_filter_notify_observers(filter, event, packet);
                 return WR_OK;
             }
-            delay = ignuin(state->min_delay, state->max_delay);
+            delay = wr_prng_uniform_int(&state->prng, state->min_delay, state->max_delay);
             wr_rtp_packet_copy(&new_packet, packet);
-            timeval_increment(&new_packet.lowlevel_timestamp, delay);
+            new_packet.lowlevel_timestamp += delay * WR_NSEC_PER_USEC;
             wr_rtp_filter_notify_observers(filter, event, &new_packet);
             return WR_OK;
         }
@@ -74,3 +74,26 @@ wr_errorcode_t wr_uniform_delay_filter_notify(wr_rtp_filter_t * filter, wr_event
         }
     }  
 }
+
+
+
+wr_errorcode_t wr_uniform_delay_filter_notify_batch(wr_rtp_filter_t * filter, wr_rtp_packet_t ** packets, int count)
+{
+    wr_uniform_delay_filter_state_t * state = (wr_uniform_delay_filter_state_t * ) (filter->state);
+    wr_rtp_packet_t new_packets[count];
+    wr_rtp_packet_t * new_packets_ptrs[count];
+    int delays[count];
+    int i;
+    if (!state->enabled){
+        wr_rtp_filter_notify_observers_batch(filter, packets, count);
+        return WR_OK;
+    }
+    wr_prng_fill_uniform_int(&state->prng, state->min_delay, state->max_delay, delays, count);
+    for (i=0; i<count; i++){
+        wr_rtp_packet_copy(&new_packets[i], packets[i]);
+        new_packets[i].lowlevel_timestamp += delays[i] * WR_NSEC_PER_USEC;
+        new_packets_ptrs[i] = &new_packets[i];
+    }
+    wr_rtp_filter_notify_observers_batch(filter, new_packets_ptrs, count);
+    return WR_OK;
+}
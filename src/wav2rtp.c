@@ -38,21 +38,11 @@
 #include "options.h"
 #include "error_types.h"
 
-#include "contrib/ranlib/ranlib.h"
 #include "misc.h"
+#include "prng.h"
 #include "rtpapi.h"
 #include "wavfile_filter.h"
-#include "dummy_filter.h"
-#include "sort_filter.h"
-#include "pcap_filter.h"
-#include "rtpdump_filter.h"
-#include "wavfile_output_filter.h"
-#include "independent_losses_filter.h"
-#include "markov_losses_filter.h"
-#include "uniform_delay_filter.h"
-#include "gamma_delay_filter.h"
-#include "log_filter.h"
-#include "sipp_filter.h"
+#include "pipeline.h"
 
 #include "speex_codec.h"
 #include "dummy_codec.h"
@@ -61,37 +51,11 @@
 
 char wr_error[2048];
 
-#ifdef _WIN32
-void timersub(const struct timeval *a, const struct timeval *b, struct timeval *res)
-{
-    res->tv_sec = (a)->tv_sec - (b)->tv_sec;
-    res->tv_usec = (a)->tv_usec - (b)->tv_usec;
-    if (res->tv_usec < 0) {
-        --res->tv_sec;
-        res->tv_usec += 1000000;
-    }
-}
-#endif
-
 int main(int argc, char ** argv)
 {
 
 
-    wr_rtp_filter_t wavfile_filter;
-
-    wr_rtp_filter_t gamma_delay_filter;
-    wr_rtp_filter_t uniform_delay_filter;
-
-    wr_rtp_filter_t markov_losses_filter;
-    wr_rtp_filter_t independent_losses_filter;
-
-    wr_rtp_filter_t log_filter;
-    wr_rtp_filter_t pcap_filter;
-    wr_rtp_filter_t rtpdump_filter;
-    wr_rtp_filter_t wavfile_output_filter;
-    wr_rtp_filter_t sipp_filter;
-    wr_rtp_filter_t sort_filter;
-
+    wr_pipeline_t pipeline;
     wr_errorcode_t retval;
 
     /* parse options */
@@ -103,46 +67,33 @@ int main(int argc, char ** argv)
         return 0;
     }
 
-    /* initialize random number generator */
+    /* initialize random number generator, the same seed gives the same output */
     {
-        unsigned seed;
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        memcpy(&seed, &tv, sizeof(seed));
-        srand(seed);
-        setall(rand(), rand());
+        uint64_t seed = (uint64_t)wr_time_now();
+        char * seed_option = iniparser_getstring(wr_options.output_options, "global:seed", NULL);
+        if (seed_option && *seed_option){
+            char * end;
+            seed = strtoull(seed_option, &end, 0);
+            if (*end){
+                fprintf(stderr, "FATAL ERROR: global:seed is not a number: %s\n", seed_option);
+                return WR_FATAL;
+            }
+        }
+        srand((unsigned)(seed ^ (seed >> 32)));
+        wr_prng_seed(seed);
     }
 
-    wr_rtp_filter_create(&wavfile_filter, "input wav file filter", &wr_do_nothing_on_notify);
-
-    wr_rtp_filter_create(&gamma_delay_filter, "gamma delay intermediate filter", &wr_gamma_delay_filter_notify);
-    wr_rtp_filter_create(&uniform_delay_filter, "uniform_delay intermediate filter", &wr_uniform_delay_filter_notify);
-
-    wr_rtp_filter_create(&markov_losses_filter, "markov_losses intermediate filter", &wr_markov_losses_filter_notify);
-    wr_rtp_filter_create(&independent_losses_filter, "independent_losses intermediate filter", &wr_independent_losses_filter_notify);
-
-    wr_rtp_filter_create(&log_filter, "log intermediate filter", &wr_log_filter_notify);
-    wr_rtp_filter_create(&pcap_filter, "pcap output filter", &wr_pcap_filter_notify);
-    wr_rtp_filter_create(&rtpdump_filter, "rtpdump output filter", &wr_rtpdump_filter_notify);
-    wr_rtp_filter_create(&log_filter, "log filter", &wr_log_filter_notify);
-    wr_rtp_filter_create(&sipp_filter, "sipp filter", &wr_sipp_filter_notify);
-    wr_rtp_filter_create(&sort_filter, "sort filter", &wr_sort_filter_notify);
-    wr_rtp_filter_create(&wavfile_output_filter, "sort filter", &wr_wavfile_output_filter_notify);
-
-    wr_rtp_filter_append_observer(&wavfile_filter, &gamma_delay_filter);
-    wr_rtp_filter_append_observer(&gamma_delay_filter, &uniform_delay_filter);
-    wr_rtp_filter_append_observer(&uniform_delay_filter, &sort_filter);
-    wr_rtp_filter_append_observer(&sort_filter, &markov_losses_filter);
-    wr_rtp_filter_append_observer(&markov_losses_filter, &independent_losses_filter);
-
-    wr_rtp_filter_append_observer(&independent_losses_filter, &log_filter);
-    wr_rtp_filter_append_observer(&independent_losses_filter, wr_options.output_format == WR_OUTPUT_RTPDUMP ? &rtpdump_filter : &pcap_filter);
-    wr_rtp_filter_append_observer(&independent_losses_filter, &wavfile_output_filter);
-    wr_rtp_filter_append_observer(&independent_losses_filter, &sipp_filter);
+    retval = wr_pipeline_build(&pipeline);
+    if (retval != WR_OK) {
+        wr_print_error();
+        return retval;
+    }
 
-    retval = wr_wavfile_filter_start(&wavfile_filter);
+    retval = wr_wavfile_filter_start(&pipeline.source);
     if (retval != WR_OK) {
         wr_print_error();
     }
+    wr_pipeline_print_stats(&pipeline);
+    wr_pipeline_destroy(&pipeline);
     return retval;
 }
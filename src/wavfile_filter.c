@@ -32,6 +32,7 @@
  *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  */
+#include <pthread.h>
 #include <sndfile.h>
 #include "rtpapi.h"
 #include "codecapi.h"
@@ -39,6 +40,60 @@
 #include "options.h"
 #include "misc.h"
 #include "rtpmap.h"
+#include "packet_pool.h"
+#include "wavfile_mmap.h"
+
+
+/**
+ * Packetizer groups encoded frames into RTP packets and sends them to observers in batches
+ */
+typedef struct __wr_packetizer {
+    wr_rtp_filter_t * filter;
+    wr_packet_pool_t pool;
+    wr_rtp_packet_t * rtp_packet;
+    wr_rtp_packet_t * batch[WR_MAX_BATCH_SIZE];
+    int batch_count;
+    int batch_size;
+    int rtp_in_frame;
+    int frames_count;
+    int sequence_number;
+    int rtp_timestamp;
+    wr_time_t packet_start_timestamp;
+    wr_time_t packet_end_timestamp;
+    wr_time_t clock_base;       /**< time of the last whole second of the sample clock */
+    int64_t clock_samples;      /**< samples sent since clock_base */
+    int clock_rate;             /**< sample rate of the sample clock */
+} wr_packetizer_t;
+
+
+/**
+ * Encoded frame of the #wr_encoded_stream_t
+ */
+typedef struct __wr_encoded_frame {
+    size_t offset;      /**< offset of the frame data in wr_encoded_stream_t#data */
+    size_t size;        /**< size of the frame data */
+    int samples;        /**< number of samples encoded in the frame */
+} wr_encoded_frame_t;
+
+
+/**
+ * Whole input signal encoded with one codec (used to encode with several codecs in parallel)
+ */
+typedef struct __wr_encoded_stream {
+    wr_encoder_t * codec;
+    const short * samples;
+    size_t samples_count;
+    uint8_t * data;
+    size_t data_size;
+    size_t data_capacity;
+    wr_encoded_frame_t * frames;
+    int frames_count;
+    int frames_capacity;
+    wr_errorcode_t retval;
+    pthread_t thread;
+} wr_encoded_stream_t;
+
+
 
 static int get_format_payload_type(int format)
 {
@@ -50,57 +105,147 @@ static int get_format_payload_type(int format)
     return -1;
 }
 
-wr_errorcode_t wr_wavfile_filter_start(wr_rtp_filter_t * filter)
+
+
+/**
+ * Send collected packets to observers and return them to the pool
+ */
+static void __flush_batch(wr_packetizer_t * p)
 {
+    int i;
+    wr_rtp_filter_notify_observers_batch(p->filter, p->batch, p->batch_count);
+    for (i=0; i<p->batch_count; i++)
+        wr_packet_pool_release(&p->pool, p->batch[i]);
+    p->batch_count = 0;
+}
 
-    SNDFILE * file;
-    SF_INFO file_info;
-    wr_encoder_t * codec = NULL;
-    wr_rtp_packet_t rtp_packet;
-    int sequence_number = 0;
-    int rtp_timestamp = 0;
-    struct timeval packet_start_timestamp;
-    struct timeval packet_end_timestamp;
-
-    gettimeofday(&packet_start_timestamp, NULL);
-    timeval_copy(&packet_end_timestamp, &packet_start_timestamp);
-
-    int rtp_in_frame = iniparser_getpositiveint(wr_options.output_options, "global:rtp_in_frame", 1);
-    int frames_count = 0;
-
-    /* open WAV file */
-    file = sf_open(wr_options.filename, SFM_READ, &file_info);
-    if (!file){
-        wr_set_error("cannot open or render sound file");
+
+
+static wr_errorcode_t __packetizer_start(wr_packetizer_t * p, wr_rtp_filter_t * filter, int payload_type)
+{
+    memset(p, 0, sizeof(*p));
+    p->filter = filter;
+    p->rtp_in_frame = iniparser_getpositiveint(wr_options.output_options, "global:rtp_in_frame", 1);
+    p->batch_size = iniparser_getpositiveint(wr_options.output_options, "global:batch_size", 16);
+    if (p->rtp_in_frame > WR_MAX_DATA_FRAMES){
+        wr_set_error("global:rtp_in_frame is too large");
         return WR_FATAL;
     }
-    if (file_info.samplerate != 8000){
-        wr_set_error("this tool works only with .wav files in 8kHz, rerecord "
-                     "your signal or resample it (with sox, for example; like "
-                     "'sox input.wav -r8000 resampled.wav')\n" );
+    if (p->batch_size > WR_MAX_BATCH_SIZE){
+        wr_set_error("global:batch_size is too large");
         return WR_FATAL;
     }
+    /* start time may be fixed to get identical captures from identical runs */
+    p->packet_start_timestamp = (wr_time_t)(iniparser_getdouble(wr_options.output_options, "global:start_time", 0) * WR_NSEC_PER_SEC);
+    if (p->packet_start_timestamp <= 0)
+        p->packet_start_timestamp = wr_time_now();
+    p->packet_end_timestamp = p->packet_start_timestamp;
 
-    if (list_empty(wr_options.codec_list)) {
-        codec = get_encoder_by_pt(get_format_payload_type(file_info.format));
-        if (codec && !(*codec->init)(codec)) {
-            wr_set_error("Cannot initialize codec");
-            return WR_FATAL;
-        }
-    } else {
-        list_iterator_start(wr_options.codec_list);
-        if (list_iterator_hasnext(wr_options.codec_list)){
-            codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
-        }
+    /* packets are recycled through the pool after each batch is sent */
+    wr_packet_pool_init(&p->pool);
+    p->rtp_packet = wr_packet_pool_acquire(&p->pool, payload_type, p->sequence_number, 1, p->rtp_timestamp, p->packet_start_timestamp);
+    if (!p->rtp_packet){
+        wr_packet_pool_destroy(&p->pool);
+        wr_set_error("cannot allocate rtp packet");
+        return WR_FATAL;
     }
-    if (!codec) {
-        wr_set_error("no codec is found");
+    wr_rtp_filter_notify_observers(filter, TRANSMISSION_START, p->rtp_packet);
+    return WR_OK;
+}
+
+
+
+/**
+ * Put current packet into the batch and start the next one
+ */
+static wr_errorcode_t __packetizer_next_packet(wr_packetizer_t * p)
+{
+    int payload_type = p->rtp_packet->payload_type;
+    p->batch[p->batch_count++] = p->rtp_packet;
+    if (p->batch_count == p->batch_size)
+        __flush_batch(p);
+    p->frames_count = 0;
+    p->sequence_number++;
+    p->packet_start_timestamp = p->packet_end_timestamp;
+    p->rtp_packet = wr_packet_pool_acquire(&p->pool, payload_type, p->sequence_number, 0, p->rtp_timestamp, p->packet_start_timestamp);
+    if (!p->rtp_packet){
+        wr_set_error("cannot allocate rtp packet");
         return WR_FATAL;
     }
+    return WR_OK;
+}
+
+
+
+/**
+ * Advance the end of the current packet by the given number of samples.
+ * Time is counted exactly from the last whole second of the sample clock,
+ * so rounding errors do not accumulate in long streams.
+ */
+static void __packetizer_advance_clock(wr_packetizer_t * p, int samples, int samplerate)
+{
+    if (samplerate != p->clock_rate){
+        p->clock_base = p->packet_end_timestamp;
+        p->clock_samples = 0;
+        p->clock_rate = samplerate;
+    }
+    p->clock_samples += samples;
+    if (p->clock_samples >= samplerate){
+        p->clock_base += p->clock_samples / samplerate * WR_NSEC_PER_SEC;
+        p->clock_samples %= samplerate;
+    }
+    p->packet_end_timestamp = p->clock_base + p->clock_samples * WR_NSEC_PER_SEC / samplerate;
+}
+
+
+
+static wr_errorcode_t __packetizer_add_frame(wr_packetizer_t * p, int payload_type, uint8_t * data, size_t size, int samples, int samplerate)
+{
+    /* the packet may have been started before the codec was changed */
+    if (!p->frames_count)
+        p->rtp_packet->payload_type = payload_type;
+    if (wr_rtp_packet_add_frame(p->rtp_packet, data, size, 1000 * samples / samplerate) != WR_OK)
+        return WR_FATAL;
+    __packetizer_advance_clock(p, samples, samplerate);
+    p->rtp_timestamp += samples;
+    p->frames_count++;
+    if (p->frames_count == p->rtp_in_frame)
+        return __packetizer_next_packet(p);
+    return WR_OK;
+}
+
+
+
+/**
+ * Send incomplete packet at the end of the input file
+ */
+static wr_errorcode_t __packetizer_end_of_stream(wr_packetizer_t * p)
+{
+    if (p->frames_count)
+        return __packetizer_next_packet(p);
+    return WR_OK;
+}
+
+
+
+static void __packetizer_stop(wr_packetizer_t * p)
+{
+    __flush_batch(p);
+    wr_rtp_filter_notify_observers(p->filter, TRANSMISSION_END, NULL);
+    if (p->rtp_packet)
+        wr_packet_pool_release(&p->pool, p->rtp_packet);
+    wr_packet_pool_destroy(&p->pool);
+    if (iniparser_getboolean(wr_options.output_options, "global:pool_stats", 0))
+        wr_packet_pool_print_stats(&p->pool, stderr);
+}
 
-    wr_rtp_packet_init(&rtp_packet, codec->payload_type, sequence_number, 1, rtp_timestamp, packet_start_timestamp);
-    wr_rtp_filter_notify_observers(filter, TRANSMISSION_START, &rtp_packet);
 
+
+/**
+ * Read file frame by frame and encode it with each codec in turn
+ */
+static wr_errorcode_t __encode_sequentially(wr_packetizer_t * p, SNDFILE * file, SF_INFO * file_info, wr_encoder_t * codec)
+{
     /* One cycle iteration encode one data frame */
     while(codec){
         int   input_buffer_size = (*codec->get_input_buffer_size)(codec->state);
@@ -108,19 +253,13 @@ wr_errorcode_t wr_wavfile_filter_start(wr_rtp_filter_t * filter)
         short input_buffer[input_buffer_size];
         char output_buffer[output_buffer_size];
 
-        memset(input_buffer, 0, input_buffer_size);
-        memset(output_buffer, 0, output_buffer_size);
+        memset(input_buffer, 0, sizeof(input_buffer));
+        memset(output_buffer, 0, sizeof(output_buffer));
 
         input_buffer_size = sf_read_short(file, input_buffer, input_buffer_size);
         if (!input_buffer_size){ /*EOF*/
-            if (frames_count){
-                wr_rtp_filter_notify_observers(filter, NEW_PACKET, &rtp_packet);
-                wr_rtp_packet_destroy(&rtp_packet);
-                frames_count = 0;
-                sequence_number++;
-                timeval_copy(&packet_start_timestamp, &packet_end_timestamp);
-                wr_rtp_packet_init(&rtp_packet, codec->payload_type, sequence_number, 0, rtp_timestamp, packet_start_timestamp);
-            }
+            if (__packetizer_end_of_stream(p) != WR_OK)
+                return WR_FATAL;
             sf_seek(file, 0, SEEK_SET);
             if (list_iterator_hasnext(wr_options.codec_list)){
                 codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
@@ -131,20 +270,290 @@ wr_errorcode_t wr_wavfile_filter_start(wr_rtp_filter_t * filter)
             continue;
         }
         output_buffer_size = (*codec->encode)(codec->state, input_buffer, output_buffer);
-        wr_rtp_packet_add_frame(&rtp_packet, output_buffer, output_buffer_size,  1000 * input_buffer_size / file_info.samplerate);
-        timeval_increment(&packet_end_timestamp, 1e6 * input_buffer_size / file_info.samplerate);
-        rtp_timestamp += input_buffer_size;
-        frames_count++;
-        if (frames_count == rtp_in_frame){
-            wr_rtp_filter_notify_observers(filter, NEW_PACKET, &rtp_packet);
-            wr_rtp_packet_destroy(&rtp_packet);
-            frames_count = 0;
-            sequence_number++;
-            timeval_copy(&packet_start_timestamp, &packet_end_timestamp);
-            wr_rtp_packet_init(&rtp_packet, codec->payload_type, sequence_number, 0, rtp_timestamp, packet_start_timestamp);
+        if (__packetizer_add_frame(p, codec->payload_type, (uint8_t *)output_buffer, output_buffer_size, 
+                    input_buffer_size, file_info->samplerate) != WR_OK)
+            return WR_FATAL;
+    }
+    return WR_OK;
+}
+
+
+
+/**
+ * Return pointer to the samples of the frame which starts at position.
+ * Samples are used in place, the last incomplete frame is copied to padded buffer and completed with zeroes.
+ */
+static const short * __frame_samples(const short * samples, size_t samples_count, size_t position, 
+        int frame_size, short * padded, int * frame_samples)
+{
+    if (position + frame_size <= samples_count){
+        *frame_samples = frame_size;
+        return samples + position;
+    }
+    *frame_samples = samples_count - position;
+    memset(padded, 0, frame_size * sizeof(short));
+    memcpy(padded, samples + position, *frame_samples * sizeof(short));
+    return padded;
+}
+
+
+
+/**
+ * Encode signal which is already in memory with each codec in turn
+ */
+static wr_errorcode_t __encode_from_memory(wr_packetizer_t * p, const short * samples, size_t samples_count, 
+        int samplerate, wr_encoder_t * codec)
+{
+    while (codec){
+        int input_buffer_size = (*codec->get_input_buffer_size)(codec->state);
+        int output_buffer_size = (*codec->get_output_buffer_size)(codec->state);
+        size_t position;
+
+        for (position = 0; input_buffer_size > 0 && position < samples_count; position += input_buffer_size){
+            short padded[input_buffer_size];
+            char output_buffer[output_buffer_size];
+            int frame_samples;
+            const short * input = __frame_samples(samples, samples_count, position, input_buffer_size, padded, &frame_samples);
+            int size = (*codec->encode)(codec->state, input, output_buffer);
+            if (__packetizer_add_frame(p, codec->payload_type, (uint8_t *)output_buffer, size, 
+                        frame_samples, samplerate) != WR_OK)
+                return WR_FATAL;
+        }
+        if (__packetizer_end_of_stream(p) != WR_OK)
+            return WR_FATAL;
+        if (list_iterator_hasnext(wr_options.codec_list)){
+            codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
+        }else{
+            codec = NULL;
+            list_iterator_stop(wr_options.codec_list);
         }
     }
-    wr_rtp_filter_notify_observers(filter, TRANSMISSION_END, NULL);
-    sf_close(file);
     return WR_OK;
 }
+
+
+
+static void * __encode_thread(void * arg)
+{
+    wr_encoded_stream_t * stream = (wr_encoded_stream_t *)arg;
+    wr_encoder_t * codec = stream->codec;
+    int input_buffer_size = (*codec->get_input_buffer_size)(codec->state);
+    size_t output_buffer_size = (*codec->get_output_buffer_size)(codec->state);
+    size_t position;
+
+    stream->retval = WR_OK;
+    if (input_buffer_size <= 0)
+        return NULL;
+    short padded[input_buffer_size];
+    for (position = 0; position < stream->samples_count; position += input_buffer_size){
+        wr_encoded_frame_t * frame;
+        int frame_samples;
+        const short * input = __frame_samples(stream->samples, stream->samples_count, position, 
+                input_buffer_size, padded, &frame_samples);
+
+        if (stream->frames_count == stream->frames_capacity){
+            int capacity = stream->frames_capacity ? stream->frames_capacity * 2 : 256;
+            wr_encoded_frame_t * frames = realloc(stream->frames, capacity * sizeof(wr_encoded_frame_t));
+            if (!frames){
+                stream->retval = WR_FATAL;
+                return NULL;
+            }
+            stream->frames = frames;
+            stream->frames_capacity = capacity;
+        }
+        if (stream->data_capacity - stream->data_size < output_buffer_size){
+            size_t capacity = stream->data_capacity ? stream->data_capacity * 2 : 256 * output_buffer_size;
+            uint8_t * data = realloc(stream->data, capacity);
+            if (!data){
+                stream->retval = WR_FATAL;
+                return NULL;
+            }
+            stream->data = data;
+            stream->data_capacity = capacity;
+        }
+        frame = &stream->frames[stream->frames_count++];
+        frame->offset = stream->data_size;
+        frame->samples = frame_samples;
+        frame->size = (*codec->encode)(codec->state, input, (char *)(stream->data + stream->data_size));
+        stream->data_size += frame->size;
+    }
+    return NULL;
+}
+
+
+
+/**
+ * Encode signal with all codecs at once, each codec in its own thread.
+ * Encoded streams are sent in the order of the codec list as soon as they are ready.
+ */
+static wr_errorcode_t __encode_in_parallel(wr_packetizer_t * p, const short * samples, size_t samples_count, 
+        int samplerate, int codecs_count)
+{
+    wr_errorcode_t retval = WR_OK;
+    wr_encoded_stream_t * streams;
+    int started = 0, i, j;
+
+    streams = calloc(codecs_count, sizeof(wr_encoded_stream_t));
+    if (!streams){
+        wr_set_error("cannot allocate memory for encoded streams");
+        return WR_FATAL;
+    }
+
+    list_iterator_start(wr_options.codec_list);
+    while (list_iterator_hasnext(wr_options.codec_list)){
+        wr_encoded_stream_t * stream = &streams[started];
+        stream->codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
+        stream->samples = samples;
+        stream->samples_count = samples_count;
+        if (pthread_create(&stream->thread, NULL, &__encode_thread, stream)){
+            wr_set_error("cannot create encoder thread");
+            retval = WR_FATAL;
+            break;
+        }
+        started++;
+    }
+    list_iterator_stop(wr_options.codec_list);
+
+    for (i=0; i<started; i++){
+        wr_encoded_stream_t * stream = &streams[i];
+        pthread_join(stream->thread, NULL);
+        if (retval == WR_OK && stream->retval != WR_OK){
+            wr_set_error("cannot allocate memory for the encoded signal");
+            retval = WR_FATAL;
+        }
+        for (j=0; j<stream->frames_count && retval == WR_OK; j++){
+            wr_encoded_frame_t * frame = &stream->frames[j];
+            retval = __packetizer_add_frame(p, stream->codec->payload_type, stream->data + frame->offset, frame->size, 
+                    frame->samples, samplerate);
+        }
+        if (retval == WR_OK)
+            retval = __packetizer_end_of_stream(p);
+        free(stream->data);
+        free(stream->frames);
+    }
+    free(streams);
+    return retval;
+}
+
+
+
+/**
+ * Read the whole file into memory and encode it with all codecs in parallel
+ */
+static wr_errorcode_t __read_and_encode_in_parallel(wr_packetizer_t * p, SNDFILE * file, SF_INFO * file_info, int codecs_count)
+{
+    wr_errorcode_t retval;
+    sf_count_t samples_count;
+    short * samples = malloc(file_info->frames * file_info->channels * sizeof(short));
+    if (!samples){
+        wr_set_error("cannot allocate memory for the input signal");
+        return WR_FATAL;
+    }
+    samples_count = sf_read_short(file, samples, file_info->frames * file_info->channels);
+    retval = __encode_in_parallel(p, samples, samples_count > 0 ? samples_count : 0, file_info->samplerate, codecs_count);
+    free(samples);
+    return retval;
+}
+
+
+
+wr_errorcode_t wr_wavfile_filter_start(wr_rtp_filter_t * filter)
+{
+
+    SNDFILE * file = NULL;
+    SF_INFO file_info;
+    wr_wavfile_mmap_t wavfile;
+    int mapped = 0;
+    int samplerate;
+    int format_payload_type;
+    wr_encoder_t * codec = NULL;
+    wr_packetizer_t packetizer;
+    wr_errorcode_t retval;
+    int parallel = iniparser_getboolean(wr_options.output_options, "global:parallel_codecs", 0);
+    int codecs_count = 0;
+
+    /* 16-bit PCM mono files are mapped into memory, others are read with libsndfile */
+    if (iniparser_getboolean(wr_options.output_options, "global:mmap_input", 1) 
+            && wr_wavfile_mmap_open(&wavfile, wr_options.filename) == WR_OK){
+        mapped = 1;
+        samplerate = wavfile.samplerate;
+        format_payload_type = -1;
+    } else {
+        /* open WAV file */
+        file = sf_open(wr_options.filename, SFM_READ, &file_info);
+        if (!file){
+            wr_set_error("cannot open or render sound file");
+            return WR_FATAL;
+        }
+        samplerate = file_info.samplerate;
+        format_payload_type = get_format_payload_type(file_info.format);
+    }
+    if (samplerate != 8000){
+        wr_set_error("this tool works only with .wav files in 8kHz, rerecord "
+                     "your signal or resample it (with sox, for example; like "
+                     "'sox input.wav -r8000 resampled.wav')\n" );
+        return WR_FATAL;
+    }
+
+    if (list_empty(wr_options.codec_list)) {
+        codec = get_encoder_by_pt(format_payload_type);
+        if (codec && !(*codec->init)(codec)) {
+            wr_set_error("Cannot initialize codec");
+            return WR_FATAL;
+        }
+    } else {
+        codecs_count = list_size(wr_options.codec_list);
+        /* the same codec cannot be shared between threads */
+        if (parallel){
+            int i, j;
+            for (i=0; i<codecs_count && parallel; i++){
+                for (j=i+1; j<codecs_count; j++){
+                    if (list_get_at(wr_options.codec_list, i) == list_get_at(wr_options.codec_list, j)){
+                        parallel = 0;
+                        break;
+                    }
+                }
+            }
+        }
+        list_iterator_start(wr_options.codec_list);
+        if (list_iterator_hasnext(wr_options.codec_list)){
+            codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
+        }
+    }
+    if (!codec) {
+        wr_set_error("no codec is found");
+        return WR_FATAL;
+    }
+
+    if (__packetizer_start(&packetizer, filter, codec->payload_type) != WR_OK){
+        if (mapped)
+            wr_wavfile_mmap_close(&wavfile);
+        else
+            sf_close(file);
+        return WR_FATAL;
+    }
+    parallel = parallel && codecs_count > 1;
+    if (parallel)
+        list_iterator_stop(wr_options.codec_list);
+    if (mapped && parallel){
+        retval = __encode_in_parallel(&packetizer, wavfile.samples, wavfile.samples_count, samplerate, codecs_count);
+    } else if (mapped){
+        retval = __encode_from_memory(&packetizer, wavfile.samples, wavfile.samples_count, samplerate, codec);
+    } else if (parallel && file_info.frames > 0){
+        /* the length of the file has to be known to read it at once */
+        retval = __read_and_encode_in_parallel(&packetizer, file, &file_info, codecs_count);
+    } else {
+        if (parallel){
+            /* restart the codec list which was stopped for parallel encoding */
+            list_iterator_start(wr_options.codec_list);
+            codec = (wr_encoder_t*)list_iterator_next(wr_options.codec_list);
+        }
+        retval = __encode_sequentially(&packetizer, file, &file_info, codec);
+    }
+    __packetizer_stop(&packetizer);
+    if (mapped)
+        wr_wavfile_mmap_close(&wavfile);
+    else
+        sf_close(file);
+    return retval;
+}
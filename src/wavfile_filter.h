@@ -42,6 +42,12 @@
 /**
  * Start read data from file and send them via "notification interface"
  * (use #wr_options)
+ *
+ * File is encoded with each codec of the codec list in turn. If "global:parallel_codecs" option is true, 
+ * the file is read into memory once and encoded with all codecs in parallel threads, encoded streams are 
+ * sent in the order of the codec list with continuous sequence numbers and timestamps.
+ *
+ * 16-bit PCM mono files are mapped into memory (see @ref wavfile_mmap) unless "global:mmap_input" is false.
  */
 wr_errorcode_t wr_wavfile_filter_start(wr_rtp_filter_t * filter);
 /** @} */
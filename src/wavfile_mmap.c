@@ -0,0 +1,163 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "wavfile_mmap.h"
+
+#define WAVE_FORMAT_PCM 1
+
+
+
+static uint32_t __read_le32(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+
+static uint16_t __read_le16(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+
+
+/**
+ * Find offset of the data of the chunk with given id, chunks are padded to even size
+ */
+static size_t __find_chunk(const uint8_t * data, size_t length, const char * id, uint32_t * size)
+{
+    size_t offset = 12;
+    while (offset + 8 <= length){
+        uint32_t chunk_size = __read_le32(data + offset + 4);
+        if (memcmp(data + offset, id, 4) == 0){
+            *size = chunk_size;
+            return offset + 8;
+        }
+        offset += 8 + (size_t)chunk_size + (chunk_size & 1);
+    }
+    return 0;
+}
+
+
+
+/**
+ * Check that the file contains 16-bit PCM mono signal in 8kHz and find its samples
+ */
+static wr_errorcode_t __parse(wr_wavfile_mmap_t * wavfile)
+{
+    const uint8_t * data = wavfile->base;
+    size_t fmt_offset, data_offset;
+    uint32_t fmt_size, data_size;
+
+    if (wavfile->length < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+        return WR_WARN;
+    fmt_offset = __find_chunk(data, wavfile->length, "fmt ", &fmt_size);
+    if (!fmt_offset || fmt_size < 16 || fmt_offset + 16 > wavfile->length)
+        return WR_WARN;
+    if (__read_le16(data + fmt_offset) != WAVE_FORMAT_PCM     /* format tag */
+            || __read_le16(data + fmt_offset + 2) != 1        /* channels */
+            || __read_le32(data + fmt_offset + 4) != 8000     /* sample rate */
+            || __read_le16(data + fmt_offset + 14) != 16)     /* bits per sample */
+        return WR_WARN;
+    data_offset = __find_chunk(data, wavfile->length, "data", &data_size);
+    /* samples are read in place, they have to be aligned */
+    if (!data_offset || (data_offset & 1))
+        return WR_WARN;
+    /* size of the data chunk may be not set by streaming writers */
+    if (data_size > wavfile->length - data_offset)
+        data_size = wavfile->length - data_offset;
+    wavfile->samples = (const short *)(data + data_offset);
+    wavfile->samples_count = data_size / 2;
+    wavfile->samplerate = 8000;
+    return WR_OK;
+}
+
+
+
+wr_errorcode_t wr_wavfile_mmap_open(wr_wavfile_mmap_t * wavfile, const char * filename)
+{
+#if defined(_WIN32) || defined(WORDS_BIGENDIAN)
+    /* samples are little-endian, mapping is used only if they may be read as is */
+    return WR_WARN;
+#else
+    struct stat st;
+    int fd;
+
+    memset(wavfile, 0, sizeof(*wavfile));
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return WR_WARN;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0){
+        close(fd);
+        return WR_WARN;
+    }
+    wavfile->length = st.st_size;
+    wavfile->base = mmap(NULL, wavfile->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (wavfile->base == MAP_FAILED){
+        wavfile->base = NULL;
+        return WR_WARN;
+    }
+    if (__parse(wavfile) != WR_OK){
+        wr_wavfile_mmap_close(wavfile);
+        return WR_WARN;
+    }
+    madvise(wavfile->base, wavfile->length, MADV_SEQUENTIAL);
+    return WR_OK;
+#endif
+}
+
+
+
+void wr_wavfile_mmap_close(wr_wavfile_mmap_t * wavfile)
+{
+#if !defined(_WIN32) && !defined(WORDS_BIGENDIAN)
+    if (wavfile->base)
+        munmap(wavfile->base, wavfile->length);
+#endif
+    wavfile->base = NULL;
+    wavfile->samples = NULL;
+    wavfile->samples_count = 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * $Id$
+ * 
+ * Copyright (c) 2007, R.Imankulov
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *  this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the R.Imankulov nor the names of its contributors may
+ *  be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef WAVFILE_MMAP_H
+#define WAVFILE_MMAP_H
+#include <stddef.h>
+#include <stdint.h>
+#include "error_types.h"
+
+/** @defgroup wavfile_mmap memory mapped wav file
+ * Fast path for the most common input: RIFF WAVE file with 16-bit PCM mono signal in 8kHz.
+ * File is mapped into memory and codecs read samples directly from the mapping, without libsndfile.
+ * Other files are read with libsndfile.
+ *  @{
+ */
+
+/** Memory mapped wav file */
+typedef struct __wr_wavfile_mmap {
+    void * base;            /**< address of the mapping */
+    size_t length;          /**< length of the mapping */
+    const short * samples;  /**< samples of the signal */
+    size_t samples_count;   /**< number of samples */
+    int samplerate;         /**< sample rate of the signal */
+} wr_wavfile_mmap_t;
+
+/**
+ * Map the wav file and validate its RIFF, fmt and data chunks
+ * @return WR_OK if file is mapped, WR_WARN if the file has to be read with libsndfile
+ */
+wr_errorcode_t wr_wavfile_mmap_open(wr_wavfile_mmap_t * wavfile, const char * filename);
+
+/**
+ * Unmap the file
+ */
+void wr_wavfile_mmap_close(wr_wavfile_mmap_t * wavfile);
+
+/** @} */
+#endif
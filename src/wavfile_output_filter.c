@@ -39,27 +39,23 @@
 
 
 
-wr_errorcode_t wr_wavfile_seek(wr_wavfile_output_filter_state_t * state, const struct timeval * tv)
+wr_errorcode_t wr_wavfile_seek(wr_wavfile_output_filter_state_t * state, wr_time_t time)
 {
-    if (timercmp(tv, &state->end_time, >)){
-        struct timeval tv_offset;
+    if (time > state->end_time){
         int offset;
         short * data;
 
-        timersub(tv, &state->end_time, &tv_offset); 
-        offset = (int)((tv_offset.tv_sec * 1e6 + tv_offset.tv_usec) * state->file_info.samplerate / 1e6);
+        offset = (int)((time - state->end_time) * state->file_info.samplerate / WR_NSEC_PER_SEC);
         data = calloc(offset, sizeof(short));
         memset(data, 0, sizeof(offset * sizeof(short)));
         sf_seek(state->file, 0, SEEK_END);
         sf_write_short(state->file, data, offset);
-        memcpy(&state->end_time, tv, sizeof(struct timeval));
+        state->end_time = time;
         free(data);
     } else {
-        struct timeval tv_offset;
         int offset;
 
-        timersub(tv, &state->start_time, &tv_offset); 
-        offset = (int)((tv_offset.tv_sec * 1e6 + tv_offset.tv_usec) * state->file_info.samplerate / 1e6);
+        offset = (int)((time - state->start_time) * state->file_info.samplerate / WR_NSEC_PER_SEC);
         sf_seek(state->file, offset, SEEK_SET);
         
     }
@@ -87,15 +83,15 @@ wr_errorcode_t wr_wavfile_output_filter_notify(wr_rtp_filter_t * filter, wr_even
             {
                 wr_wavfile_output_filter_state_t * state = (wr_wavfile_output_filter_state_t * ) (filter->state);
                 wr_decoder_t * decoder = get_decoder_by_pt(packet->payload_type);
-                struct timeval tv_offset;
                 int offset = 0;
+                int i;
 
 
-                if (!timerisset(&state->start_time)){
-                    memcpy(&state->start_time, &packet->lowlevel_timestamp, sizeof(struct timeval)); 
+                if (!state->start_time){
+                    state->start_time = packet->lowlevel_timestamp;
                 } 
-                if (!timerisset(&state->end_time)){
-                    memcpy(&state->end_time, &packet->lowlevel_timestamp, sizeof(struct timeval)); 
+                if (!state->end_time){
+                    state->end_time = packet->lowlevel_timestamp;
                 } 
 
                 if (!decoder){
@@ -105,18 +101,16 @@ wr_errorcode_t wr_wavfile_output_filter_notify(wr_rtp_filter_t * filter, wr_even
                 if (!wr_decoder_is_initialized(decoder))
                     decoder->init(decoder);
 
-                wr_wavfile_seek(state, &packet->lowlevel_timestamp);
-                list_iterator_start(&packet->data_frames);
-                while(list_iterator_hasnext(&packet->data_frames)){                    
-                    wr_data_frame_t * frame = (wr_data_frame_t * ) list_iterator_next(&packet->data_frames);
+                wr_wavfile_seek(state, packet->lowlevel_timestamp);
+                for (i=0; i<packet->frames_count; i++){
+                    wr_data_frame_t * frame = &packet->data_frames[i];
                     int output_size = decoder->get_output_buffer_size(decoder->state);
                     short * output  =  calloc(output_size, sizeof(short));
-                    decoder->decode(decoder->state, frame->data, frame->size, output);
+                    decoder->decode(decoder->state, (char *)wr_data_frame_data(packet, frame), frame->size, output);
                     sf_write_short(state->file, output, output_size);
-                    timeval_increment(&state->end_time, frame->length_in_ms * 1000);
+                    state->end_time += frame->length_in_ms * WR_NSEC_PER_MSEC;
                     free(output);
                 }
-                list_iterator_stop(&packet->data_frames);
             }
             return WR_OK;
 
@@ -49,15 +49,15 @@
 typedef struct __wr_wavfile_output_filter_state {
     SF_INFO file_info;
     SNDFILE * file; 
-    struct timeval start_time;
-    struct timeval end_time;      /**<  store the timestamp of the latest sample written to file */
+    wr_time_t start_time;
+    wr_time_t end_time;           /**<  store the timestamp of the latest sample written to file */
 } wr_wavfile_output_filter_state_t;
 
 
 /**
- * Seek to position given in struct timeval. If it's needed extend file by zeroes
+ * Seek to position given in nanoseconds. If it's needed extend file by zeroes
  */
-wr_errorcode_t wr_wavfile_seek(wr_wavfile_output_filter_state_t *, const struct timeval * );
+wr_errorcode_t wr_wavfile_seek(wr_wavfile_output_filter_state_t *, wr_time_t);
 
 /**
  * Store data into file 
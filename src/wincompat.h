@@ -46,6 +46,12 @@ struct udphdr
 
 struct ether_addr *ether_aton (const char *str);
 
+struct iovec
+{
+  void * iov_base;
+  size_t iov_len;
+};
+
 #endif
 
 #endif